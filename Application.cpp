@@ -4,10 +4,16 @@
 
 #include "Application.h"
 
-Application::Application(unsigned int ws)
-        : m_workes( m_eventLoop, ws ), m_timer( m_eventLoop ), m_taskPool( T_taskInitCount ),
+Application::Application(unsigned int ws, bool prefault, Timer::Mode timerMode, std::size_t taskCapacity, QueuePolicy taskPolicy)
+        : m_workes( m_eventLoop, ws, taskCapacity, taskPolicy ), m_timer( m_eventLoop, TimingWheel::T_defaultTick, timerMode ), m_blockSource( true ),
+          m_taskPool( T_taskInitCount, prefault ? static_cast<BlockSource&>( m_blockSource ) : BlockSource::heap() ),
           m_alloc( m_taskPool ), m_eventLoop(m_alloc) {
 
+    // Map and touch the pool memory up front instead of during the first traffic spike
+    if( prefault ) {
+        m_taskPool.reserve( T_prefaultCount );
+    }
+
     m_eventLoop.setWorkers( m_workes );
     m_eventLoop.setTimer( m_timer );
 }
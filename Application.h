@@ -10,6 +10,7 @@
 #include "Timer.h"
 #include "WorkerPool.h"
 #include "PoolDefs.h"
+#include "BlockSource.h"
 
 /**
  * Abstract Application Class
@@ -25,6 +26,11 @@ protected:
     using T_Pool= PoolDefs::T_EventPool;
 
     static constexpr size_t T_taskInitCount= 100;
+    static constexpr size_t T_prefaultCount= 1000;
+
+    // The blocks of the task pool are far smaller than a huge page, so they are
+    // allocated on the heap and only prefaulted
+    HeapBlockSource m_blockSource;
     T_Pool m_taskPool;
 
     PoolAllocator< T_Pool > m_alloc;
@@ -34,7 +40,13 @@ protected:
 public:
     static constexpr unsigned int T_defaultWorkerCount= 3;
 
-    explicit Application( unsigned int ws= T_defaultWorkerCount );
+    /**
+     * @param taskCapacity - Max number of tasks waiting for a worker: zero for no limit
+     * @param taskPolicy - Behaviour when a task is submitted while the limit is reached
+     */
+    explicit Application( unsigned int ws= T_defaultWorkerCount, bool prefault= false,
+                          Timer::Mode timerMode= Timer::Mode::Thread,
+                          std::size_t taskCapacity= 0, QueuePolicy taskPolicy= QueuePolicy::Block );
 
     ~Application();
 
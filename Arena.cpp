@@ -0,0 +1,100 @@
+//
+// Created by Matthias Preymann on 24.09.2019.
+//
+
+#include <stdexcept>
+#include "Arena.h"
+
+Arena::Arena( std::size_t chunkSize, BlockSource& src )
+        : m_source( src ), m_chunkSize( chunkSize ), m_nextChunk( 0 ),
+          m_pos( nullptr ), m_end( nullptr ), m_destructors( nullptr ), m_pins( 0 ) {
+    if( !m_chunkSize ) {
+        throw std::runtime_error("Chunk size of Arena cannot be zero.");
+    }
+}
+
+Arena::~Arena() {
+    destroyObjects();
+
+    for( auto& c : m_chunks ) {
+        m_source.releaseBlock( c.m_begin, c.m_size, T_chunkAlign );
+    }
+
+    for( auto& c : m_largeChunks ) {
+        m_source.releaseBlock( c.m_begin, c.m_size, T_chunkAlign );
+    }
+}
+
+void* Arena::allocateSlow( std::size_t size, std::size_t align ) {
+    const auto alignedSize= size+ (align > T_chunkAlign ? align : 0);
+
+    // Requests that do not fit into a chunk get their own one
+    if( alignedSize > m_chunkSize ) {
+        m_largeChunks.reserve( m_largeChunks.size()+ 1 );
+        auto block= static_cast<char*>( m_source.allocateBlock( alignedSize, T_chunkAlign ) );
+        m_largeChunks.push_back( Chunk{ block, alignedSize } );
+
+        return alignUp( block, align );
+    }
+
+    // Continue with the next chunk and reuse it if it was already allocated
+    if( m_nextChunk == m_chunks.size() ) {
+        m_chunks.reserve( m_chunks.size()+ 1 );
+        auto block= static_cast<char*>( m_source.allocateBlock( m_chunkSize, T_chunkAlign ) );
+        m_chunks.push_back( Chunk{ block, m_chunkSize } );
+    }
+
+    auto& chunk= m_chunks[ m_nextChunk++ ];
+    auto p= alignUp( chunk.m_begin, align );
+    m_pos= p+ size;
+    m_end= chunk.m_begin+ chunk.m_size;
+
+    return p;
+}
+
+void Arena::destroyObjects( const Destructor* const last ) {
+    // The list holds the newest object first
+    while( m_destructors != last ) {
+        auto d= m_destructors;
+        m_destructors= d->m_next;
+        d->m_func( d->m_object );
+    }
+}
+
+bool Arena::reset() {
+    // Forget the newest marks whose pins were released. Older released marks are kept
+    // until the live ones above them are gone, as their memory is still in use
+    while( !m_marks.empty() && m_marks.back().m_released.load( std::memory_order_acquire ) ) {
+        m_marks.pop_back();
+    }
+
+    if( m_marks.empty() ) {
+        destroyObjects();
+
+        for( auto& c : m_largeChunks ) {
+            m_source.releaseBlock( c.m_begin, c.m_size, T_chunkAlign );
+        }
+        m_largeChunks.clear();
+
+        // Rewind to the first chunk
+        m_nextChunk= 0;
+        m_pos= m_end= nullptr;
+
+        return true;
+    }
+
+    // Only destroy what was created after the newest live pin was taken, and rewind to its position
+    const auto& mark= m_marks.back();
+    destroyObjects( mark.m_destructors );
+
+    for( auto i= mark.m_largeChunkCount; i< m_largeChunks.size(); i++ ) {
+        m_source.releaseBlock( m_largeChunks[i].m_begin, m_largeChunks[i].m_size, T_chunkAlign );
+    }
+    m_largeChunks.resize( mark.m_largeChunkCount );
+
+    m_nextChunk= mark.m_nextChunk;
+    m_pos= mark.m_pos;
+    m_end= mark.m_end;
+
+    return false;
+}
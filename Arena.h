@@ -0,0 +1,249 @@
+//
+// Created by Matthias Preymann on 24.09.2019.
+//
+
+#ifndef PROMISE_ARENA_H
+#define PROMISE_ARENA_H
+
+#include <new>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include "BlockSource.h"
+
+
+/**
+ * Arena Class
+ * Bump allocator for short lived objects, that is reset as a whole
+ * Memory is handed out from large chunks by advancing a pointer, single objects
+ * cannot be freed. Resetting the arena destroys all objects created with 'create'
+ * in reverse order and rewinds to the first chunk. The chunks are kept for
+ * reuse, only requests larger than a chunk get a chunk of their own that is
+ * released on reset
+ * A pin marks the current position of the arena. Resets only rewind to the mark
+ * of the newest pin that is still alive, so everything created before any live
+ * pin stays valid until it is released, while the memory above is reused
+ * Only the pins may be used by other threads than the owning one
+ */
+class Arena {
+private:
+    struct Chunk {
+        char* m_begin;
+        std::size_t m_size;
+    };
+
+    /**
+     * Internal Destructor Struct
+     * Linked list of the objects that have to be destructed on reset, which
+     * is stored inside the arena itself
+     */
+    struct Destructor {
+        void (*m_func)( void* );
+        void* m_object;
+        Destructor* m_next;
+    };
+
+    /**
+     * Internal Mark Struct
+     * Position of the arena when a pin was taken. Marks are kept in the order they
+     * were taken, and are removed once they are released and all newer ones are too
+     */
+    struct Mark {
+        const std::size_t m_nextChunk;
+        char* const m_pos;
+        char* const m_end;
+        Destructor* const m_destructors;
+        const std::size_t m_largeChunkCount;
+        std::atomic< bool > m_released;
+
+        Mark( const std::size_t c, char* const p, char* const e, Destructor* const d, const std::size_t l )
+                : m_nextChunk( c ), m_pos( p ), m_end( e ), m_destructors( d ), m_largeChunkCount( l ), m_released( false ) {}
+    };
+
+    static constexpr std::size_t T_chunkAlign= alignof(std::max_align_t);
+
+    BlockSource& m_source;
+    const std::size_t m_chunkSize;
+
+    std::vector< Chunk > m_chunks;
+    std::vector< Chunk > m_largeChunks;
+    std::size_t m_nextChunk;
+
+    char* m_pos;
+    char* m_end;
+
+    Destructor* m_destructors;
+    std::atomic< unsigned int > m_pins;
+    std::deque< Mark > m_marks;
+
+    static inline char* alignUp( char* const p, const std::size_t align ) {
+        const auto addr= reinterpret_cast<std::uintptr_t>( p );
+        return p+ ((align- (addr % align)) % align);
+    }
+
+    void* allocateSlow( std::size_t size, std::size_t align );
+
+    void destroyObjects( const Destructor* last= nullptr );
+
+public:
+
+    /**
+     * Pin Class
+     * Keeps everything created in the arena before the pin was taken from being
+     * reset while it is alive
+     */
+    class Pin {
+    private:
+        Arena* m_arena;
+        Mark* m_mark;
+
+    public:
+        Pin( Arena& a, Mark& m )
+                : m_arena( &a ), m_mark( &m ) {
+            m_arena->m_pins.fetch_add( 1, std::memory_order_relaxed );
+        }
+
+        Pin( const Pin& )= delete;
+
+        Pin( Pin&& p ) noexcept
+                : m_arena( p.m_arena ), m_mark( p.m_mark ) {
+            p.m_arena= nullptr;
+            p.m_mark= nullptr;
+        }
+
+        ~Pin() {
+            release();
+        }
+
+        void release() {
+            if( m_arena ) {
+                // The mark may be removed by the owning thread right after it is released
+                auto arena= m_arena;
+                m_arena= nullptr;
+                m_mark->m_released.store( true, std::memory_order_release );
+                arena->m_pins.fetch_sub( 1, std::memory_order_release );
+            }
+        }
+    };
+
+    explicit Arena( std::size_t chunkSize, BlockSource& src= BlockSource::heap() );
+
+    Arena( const Arena& )= delete;
+
+    ~Arena();
+
+    inline void* allocate( const std::size_t size, const std::size_t align= T_chunkAlign ) {
+        // Fast path: Bump the pointer inside the current chunk
+        if( m_pos ) {
+            auto p= alignUp( m_pos, align );
+            if( size <= static_cast<std::size_t>( m_end- p ) ) {
+                m_pos= p+ size;
+                return p;
+            }
+        }
+
+        return allocateSlow( size, align );
+    }
+
+    /**
+     * Construct an object in the arena
+     * Its destructor is run when the arena is reset, unless it is trivial
+     */
+    template< typename T_Element, typename ... T_Args >
+    T_Element* create( T_Args&& ... args ) {
+        auto obj= new( allocate( sizeof(T_Element), alignof(T_Element) ) ) T_Element( std::forward<T_Args>(args)... );
+
+        if constexpr ( !std::is_trivially_destructible< T_Element >::value ) {
+            auto d= new( allocate( sizeof(Destructor), alignof(Destructor) ) ) Destructor;
+            d->m_func= []( void* o ) { static_cast<T_Element*>( o )->~T_Element(); };
+            d->m_object= obj;
+            d->m_next= m_destructors;
+            m_destructors= d;
+        }
+
+        return obj;
+    }
+
+    /**
+     * Keep the memory allocated so far alive beyond the next reset
+     * Escape hatch for values that have to outlive the current event
+     */
+    inline Pin pin() {
+        m_marks.emplace_back( m_nextChunk, m_pos, m_end, m_destructors, m_largeChunks.size() );
+        return Pin( *this, m_marks.back() );
+    }
+
+    inline bool isPinned() const {
+        return m_pins.load( std::memory_order_acquire ) > 0;
+    }
+
+    /**
+     * Destroy all objects and make the memory available again, except for what is
+     * kept by the newest live pin
+     * @return False if the arena is pinned and only rewound to the pinned mark
+     */
+    bool reset();
+};
+
+
+/**
+ * Templated Arena Allocator Class
+ * Allocator for standard containers, that takes its memory from an arena
+ * Deallocation does nothing, the memory is reclaimed when the arena is reset
+ *
+ * @tparam T - Type of object to allocate
+ */
+template< typename T >
+class ArenaAllocator {
+private:
+    template< typename >
+    friend class ArenaAllocator;
+
+    Arena* m_arena;
+
+public:
+    using value_type= T;
+
+    using propagate_on_container_copy_assignment= std::true_type;
+    using propagate_on_container_move_assignment= std::true_type;
+    using propagate_on_container_swap= std::true_type;
+    using is_always_equal= std::false_type;
+
+    explicit ArenaAllocator( Arena& a ) noexcept
+            : m_arena( &a ) {}
+
+    template< typename U >
+    ArenaAllocator( const ArenaAllocator< U >& other ) noexcept
+            : m_arena( other.m_arena ) {}
+
+    T* allocate( const std::size_t n ) {
+        if( n > static_cast<std::size_t>(-1) / sizeof(T) ) {
+            throw std::bad_array_new_length();
+        }
+
+        return static_cast<T*>( m_arena->allocate( n* sizeof(T), alignof(T) ) );
+    }
+
+    void deallocate( T*, std::size_t ) {}
+
+    inline Arena& getArena() const {
+        return *m_arena;
+    }
+
+    template< typename U >
+    bool operator==( const ArenaAllocator< U >& other ) const {
+        return m_arena == other.m_arena;
+    }
+
+    template< typename U >
+    bool operator!=( const ArenaAllocator< U >& other ) const {
+        return m_arena != other.m_arena;
+    }
+};
+
+
+#endif //PROMISE_ARENA_H
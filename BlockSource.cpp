@@ -0,0 +1,121 @@
+//
+// Created by Matthias Preymann on 21.09.2019.
+//
+
+#include <new>
+#include <cstdint>
+#include "BlockSource.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define PROMISE_BLOCKSOURCE_MMAP
+#endif
+
+
+static std::size_t roundUp( const std::size_t x, const std::size_t m ) {
+    return ((x+ m- 1) / m) * m;
+}
+
+static std::size_t pageSize() {
+#ifdef PROMISE_BLOCKSOURCE_MMAP
+    return static_cast<std::size_t>( sysconf( _SC_PAGESIZE ) );
+#else
+    return 4096;
+#endif
+}
+
+/**
+ * Touch every page once to fault it in now instead of on first use
+ */
+static void touchPages( void* block, const std::size_t size ) {
+    const auto step= pageSize();
+    for( std::size_t offset= 0; offset< size; offset+= step ) {
+        static_cast<volatile char*>( block )[ offset ]= 0;
+    }
+}
+
+BlockSource& BlockSource::heap() {
+    // Never destroyed, as pools with static storage duration might outlive it otherwise
+    static HeapBlockSource* source= new HeapBlockSource();
+    return *source;
+}
+
+void* HeapBlockSource::allocateBlock( std::size_t size, std::size_t align ) {
+    auto block= ::operator new( size, std::align_val_t( align ) );
+    if( m_prefault ) {
+        touchPages( block, size );
+    }
+
+    return block;
+}
+
+void HeapBlockSource::releaseBlock( void* block, std::size_t size, std::size_t align ) {
+    ::operator delete( block, size, std::align_val_t( align ) );
+}
+
+
+#ifdef PROMISE_BLOCKSOURCE_MMAP
+
+void* MappedBlockSource::allocateBlock( std::size_t size, std::size_t align ) {
+    const auto pageSize= static_cast<std::size_t>( sysconf( _SC_PAGESIZE ) );
+
+    // Huge pages are only used if the mapping is aligned to their size
+    const bool huge= m_hugePages && size >= T_hugePageSize;
+    std::size_t alignment= huge ? T_hugePageSize : pageSize;
+    if( align > alignment ) {
+        alignment= align;
+    }
+
+    // Map more memory than needed, if the block has to be aligned beyond the page size
+    const auto length= roundUp( size, pageSize );
+    const auto mappedLength= (alignment > pageSize) ? length+ alignment : length;
+
+    auto mapping= mmap( nullptr, mappedLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( mapping == MAP_FAILED ) {
+        throw std::bad_alloc();
+    }
+
+    // Unmap the unused space in front of and behind the aligned block
+    const auto begin= reinterpret_cast<std::uintptr_t>( mapping );
+    const auto aligned= roundUp( begin, alignment );
+    if( aligned != begin ) {
+        munmap( mapping, aligned- begin );
+    }
+
+    const auto tail= (begin+ mappedLength) - (aligned+ length);
+    if( tail ) {
+        munmap( reinterpret_cast<void*>( aligned+ length ), tail );
+    }
+
+    auto block= reinterpret_cast<char*>( aligned );
+
+#ifdef MADV_HUGEPAGE
+    if( huge ) {
+        madvise( block, length, MADV_HUGEPAGE );
+    }
+#endif
+
+    if( m_prefault ) {
+        touchPages( block, length );
+    }
+
+    return block;
+}
+
+void MappedBlockSource::releaseBlock( void* block, std::size_t size, std::size_t ) {
+    const auto pageSize= static_cast<std::size_t>( sysconf( _SC_PAGESIZE ) );
+    munmap( block, roundUp( size, pageSize ) );
+}
+
+#else
+
+void* MappedBlockSource::allocateBlock( std::size_t size, std::size_t align ) {
+    return BlockSource::heap().allocateBlock( size, align );
+}
+
+void MappedBlockSource::releaseBlock( void* block, std::size_t size, std::size_t align ) {
+    BlockSource::heap().releaseBlock( block, size, align );
+}
+
+#endif
@@ -0,0 +1,75 @@
+//
+// Created by Matthias Preymann on 21.09.2019.
+//
+
+#ifndef PROMISE_BLOCKSOURCE_H
+#define PROMISE_BLOCKSOURCE_H
+
+#include <cstddef>
+
+
+/**
+ * Abstract Block Source Class
+ * Interface for the memory provider of allocation arrays
+ * Allocation arrays request their blocks of cells from a block source
+ * and hand them back when they are trimmed or destroyed
+ */
+class BlockSource {
+public:
+    virtual ~BlockSource()= default;
+
+    virtual void* allocateBlock( std::size_t size, std::size_t align )= 0;
+    virtual void releaseBlock( void* block, std::size_t size, std::size_t align )= 0;
+
+    /**
+     * Default block source, which allocates on the heap
+     */
+    static BlockSource& heap();
+};
+
+
+/**
+ * Heap Block Source Class
+ * Allocates blocks with the global aligned operator new
+ * If prefaulting is enabled all pages of a block are touched once it is
+ * allocated, so no page faults occur when its cells are first used
+ */
+class HeapBlockSource : public BlockSource {
+private:
+    const bool m_prefault;
+
+public:
+    explicit HeapBlockSource( bool prefault= false )
+            : m_prefault( prefault ) {}
+
+    void* allocateBlock( std::size_t size, std::size_t align ) override;
+    void releaseBlock( void* block, std::size_t size, std::size_t align ) override;
+};
+
+
+/**
+ * Mapped Block Source Class
+ * Maps every block as anonymous memory directly from the OS
+ * Optionally transparent huge pages are requested for the mappings, which only
+ * takes effect for blocks at least as large as a huge page, so it should be
+ * combined with large block sizes. If prefaulting is enabled all pages of a block
+ * are touched once it is mapped, so no page faults occur when its cells are first
+ * used. On platforms without mmap the blocks are allocated on the heap
+ */
+class MappedBlockSource : public BlockSource {
+private:
+    static constexpr std::size_t T_hugePageSize= 2* 1024* 1024;
+
+    const bool m_hugePages;
+    const bool m_prefault;
+
+public:
+    explicit MappedBlockSource( bool hugePages= true, bool prefault= false )
+            : m_hugePages( hugePages ), m_prefault( prefault ) {}
+
+    void* allocateBlock( std::size_t size, std::size_t align ) override;
+    void releaseBlock( void* block, std::size_t size, std::size_t align ) override;
+};
+
+
+#endif //PROMISE_BLOCKSOURCE_H
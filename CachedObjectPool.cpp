@@ -0,0 +1,95 @@
+//
+// Created by Matthias Preymann on 14.09.2019.
+//
+
+#include <algorithm>
+#include "CachedObjectPool.h"
+
+std::atomic< std::uint64_t > CachedObjectPoolDetail::ThreadCache::m_nextPoolId( 1 );
+
+std::mutex CachedObjectPoolDetail::ThreadCache::m_ownerMutex;
+
+std::vector< std::pair< std::uint64_t, CachedObjectPoolDetail::MagazineOwner* > > CachedObjectPoolDetail::ThreadCache::m_owners;
+
+thread_local CachedObjectPoolDetail::ThreadCache CachedObjectPoolDetail::ThreadCache::m_cache;
+
+CachedObjectPoolDetail::ThreadCache::~ThreadCache() {
+    // Hand the cells back to the pools that still exist, the others are gone already
+    std::lock_guard<std::mutex> lock( m_ownerMutex );
+    for( auto& mag : m_magazines ) {
+        if( auto owner= unsafeFindOwner( mag.m_poolId ) ) {
+            owner->flushMagazine( mag );
+        }
+    }
+}
+
+CachedObjectPoolDetail::MagazineOwner* CachedObjectPoolDetail::ThreadCache::unsafeFindOwner( std::uint64_t id ) {
+    for( auto& entry : m_owners ) {
+        if( entry.first == id ) {
+            return entry.second;
+        }
+    }
+
+    return nullptr;
+}
+
+void CachedObjectPoolDetail::ThreadCache::dropOrphans() {
+    std::lock_guard<std::mutex> lock( m_ownerMutex );
+    m_magazines.erase( std::remove_if( m_magazines.begin(), m_magazines.end(), []( const Magazine& mag ) {
+        return !unsafeFindOwner( mag.m_poolId );
+    }), m_magazines.end() );
+}
+
+std::uint64_t CachedObjectPoolDetail::ThreadCache::registerPool( MagazineOwner& owner ) {
+    const auto id= m_nextPoolId.fetch_add( 1, std::memory_order_relaxed );
+
+    std::lock_guard<std::mutex> lock( m_ownerMutex );
+    m_owners.emplace_back( id, &owner );
+    return id;
+}
+
+void CachedObjectPoolDetail::ThreadCache::unregisterPool( std::uint64_t id ) {
+    std::lock_guard<std::mutex> lock( m_ownerMutex );
+    for( auto it= m_owners.begin(); it!= m_owners.end(); it++ ) {
+        if( it->first == id ) {
+            m_owners.erase( it );
+            return;
+        }
+    }
+}
+
+CachedObjectPoolDetail::Magazine& CachedObjectPoolDetail::ThreadCache::get( std::uint64_t id, std::size_t capacity ) {
+    // Usually a thread only uses a few pools, so a linear search is fine
+    auto& magazines= m_cache.m_magazines;
+    for( auto& mag : magazines ) {
+        if( mag.m_poolId == id ) {
+            return mag;
+        }
+    }
+
+    // Creating a magazine is rare, so use the chance to drop the ones of destroyed pools
+    m_cache.dropOrphans();
+
+    magazines.push_back( Magazine{ id, 0, std::make_unique<void*[]>( capacity ), 0, 0 } );
+    return magazines.back();
+}
+
+CachedObjectPoolDetail::Magazine* CachedObjectPoolDetail::ThreadCache::find( std::uint64_t id ) {
+    for( auto& mag : m_cache.m_magazines ) {
+        if( mag.m_poolId == id ) {
+            return &mag;
+        }
+    }
+
+    return nullptr;
+}
+
+void CachedObjectPoolDetail::ThreadCache::remove( std::uint64_t id ) {
+    auto& magazines= m_cache.m_magazines;
+    for( auto it= magazines.begin(); it!= magazines.end(); it++ ) {
+        if( it->m_poolId == id ) {
+            magazines.erase( it );
+            return;
+        }
+    }
+}
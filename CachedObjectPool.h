@@ -0,0 +1,406 @@
+//
+// Created by Matthias Preymann on 14.09.2019.
+//
+
+#ifndef PROMISE_CACHEDOBJECTPOOL_H
+#define PROMISE_CACHEDOBJECTPOOL_H
+
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ObjectPool.h"
+
+
+namespace CachedObjectPoolDetail {
+    /**
+     * Magazine Struct
+     * Array of empty cells that a single thread holds for a single pool
+     */
+    struct Magazine {
+        std::uint64_t m_poolId;
+        std::size_t m_count;
+        std::unique_ptr< void*[] > m_cells;
+
+        // Statistics not yet folded into the pool
+        std::size_t m_creates;
+        std::size_t m_frees;
+    };
+
+    /**
+     * Abstract Magazine Owner Interface Class
+     * Implemented by pools that hand out magazines, so a thread can return its
+     * cached cells without knowing the type of the pool
+     */
+    class MagazineOwner {
+    public:
+        /**
+         * Return all cells of the magazine to the shared pool
+         */
+        virtual void flushMagazine( Magazine& mag )= 0;
+
+    protected:
+        ~MagazineOwner()= default;
+    };
+
+    /**
+     * Thread Cache Class
+     * Manages the magazines of the calling thread
+     * Magazines are identified by a unique pool id instead of the address
+     * of the pool, so that a destroyed pool is never confused with a new
+     * one that happens to be created at the same address
+     * Every pool registers itself with its id. When a thread exits the cells
+     * of its magazines are returned to all pools that are still registered,
+     * while the magazines of destroyed pools are dropped without being touched
+     */
+    class ThreadCache {
+    private:
+        static std::atomic< std::uint64_t > m_nextPoolId;
+
+        // Registered pools, guarded by the mutex
+        static std::mutex m_ownerMutex;
+        static std::vector< std::pair< std::uint64_t, MagazineOwner* > > m_owners;
+
+        static thread_local ThreadCache m_cache;
+
+        std::vector< Magazine > m_magazines;
+
+        ThreadCache() {}
+
+        ~ThreadCache();
+
+        static MagazineOwner* unsafeFindOwner( std::uint64_t id );
+
+        void dropOrphans();
+
+    public:
+        static std::uint64_t registerPool( MagazineOwner& owner );
+
+        static void unregisterPool( std::uint64_t id );
+
+        static Magazine& get( std::uint64_t id, std::size_t capacity );
+
+        static Magazine* find( std::uint64_t id );
+
+        static void remove( std::uint64_t id );
+    };
+}
+
+
+/**
+ * Templated Cached Allocation Array Class
+ * Synchronised allocation array, that puts a small per-thread cache (magazine)
+ * of empty cells in front of a shared allocation array
+ * Most allocations and deallocations are served by the magazine of the calling
+ * thread without locking. Only if the magazine runs empty or full half of it
+ * is refilled or spilled to the shared array with a single lock acquisition
+ * Cells cached by a thread are returned to the shared array when the thread
+ * exits or calls 'flushThreadCache'. Destroying the pool while other threads
+ * still cache cells of it is safe, their magazines are dropped
+ *
+ * @tparam T_CellSize     - maximal needed cell size
+ * @tparam T_CellAlign    - maximal needed cell alignment
+ * @tparam T_MagazineSize - Number of cells each thread may cache
+ */
+template< std::size_t T_CellSize, std::size_t T_CellAlign, unsigned int T_MagazineSize= 32 >
+class CachedAllocArray : public Deallocator, private CachedObjectPoolDetail::MagazineOwner {
+private:
+    static_assert( T_MagazineSize >= 2, "Magazine has to hold at least two cells." );
+
+    using T_Shared= AllocArray< T_CellSize, T_CellAlign, std::mutex >;
+
+    static constexpr std::size_t T_batchSize= T_MagazineSize / 2;
+
+    T_Shared m_shared;
+    const std::uint64_t m_id;
+
+#ifdef PROMISE_POOL_STATISTICS
+    std::atomic< std::size_t > m_creates{ 0 };
+    std::atomic< std::size_t > m_frees{ 0 };
+    std::atomic< std::size_t > m_refills{ 0 };
+    std::atomic< std::size_t > m_spills{ 0 };
+#endif
+
+    inline CachedObjectPoolDetail::Magazine& getMagazine() {
+        return CachedObjectPoolDetail::ThreadCache::get( m_id, T_MagazineSize );
+    }
+
+    /**
+     * Move the statistics counted by a magazine to the pool
+     * Only done when the magazine touches the shared array anyway
+     */
+    inline void foldStatistics( CachedObjectPoolDetail::Magazine& mag ) {
+#ifdef PROMISE_POOL_STATISTICS
+        m_creates.fetch_add( mag.m_creates, std::memory_order_relaxed );
+        m_frees.fetch_add( mag.m_frees, std::memory_order_relaxed );
+        mag.m_creates= mag.m_frees= 0;
+#else
+        (void)mag;
+#endif
+    }
+
+    void spill( CachedObjectPoolDetail::Magazine& mag ) {
+        mag.m_count-= T_batchSize;
+        m_shared.freeCells( mag.m_cells.get()+ mag.m_count, T_batchSize );
+
+#ifdef PROMISE_POOL_STATISTICS
+        m_spills.fetch_add( 1, std::memory_order_relaxed );
+#endif
+        foldStatistics( mag );
+    }
+
+    void refill( CachedObjectPoolDetail::Magazine& mag ) {
+        m_shared.allocateCells( mag.m_cells.get(), T_batchSize );
+        mag.m_count= T_batchSize;
+
+#ifdef PROMISE_POOL_STATISTICS
+        m_refills.fetch_add( 1, std::memory_order_relaxed );
+#endif
+        foldStatistics( mag );
+    }
+
+    void flushMagazine( CachedObjectPoolDetail::Magazine& mag ) override {
+        m_shared.freeCells( mag.m_cells.get(), mag.m_count );
+        mag.m_count= 0;
+        foldStatistics( mag );
+    }
+
+protected:
+    void deallocate( void* ptr ) override {
+        auto& mag= getMagazine();
+
+        // Spill half of the magazine to the shared array if it is full
+        if( mag.m_count == T_MagazineSize ) {
+            spill( mag );
+        }
+
+        mag.m_cells[ mag.m_count++ ]= ptr;
+#ifdef PROMISE_POOL_STATISTICS
+        mag.m_frees++;
+#endif
+    }
+
+    void deallocateCells( void* const* cells, const std::size_t num ) override {
+        auto& mag= getMagazine();
+
+        for( std::size_t i= 0; i!= num; i++ ) {
+            // Spill half of the magazine to the shared array if it is full
+            if( mag.m_count == T_MagazineSize ) {
+                spill( mag );
+            }
+
+            mag.m_cells[ mag.m_count++ ]= cells[i];
+        }
+
+#ifdef PROMISE_POOL_STATISTICS
+        mag.m_frees+= num;
+#endif
+    }
+
+public:
+    explicit CachedAllocArray( const unsigned int s, BlockSource& src= BlockSource::heap() )
+            : m_shared( s, src ), m_id( CachedObjectPoolDetail::ThreadCache::registerPool( *this ) ) {}
+
+    CachedAllocArray( const CachedAllocArray& )= delete;
+
+    ~CachedAllocArray() {
+        // No exiting thread may flush into the array from now on. The cells are owned
+        // by the blocks of the shared array, so only the magazine of this thread has to go
+        CachedObjectPoolDetail::ThreadCache::unregisterPool( m_id );
+        CachedObjectPoolDetail::ThreadCache::remove( m_id );
+    }
+
+    template< typename T_Element, typename ... T_Args >
+    T_Element* create( T_Args&& ... args ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        auto& mag= getMagazine();
+
+        // Refill half of the magazine from the shared array if it is empty
+        if( !mag.m_count ) {
+            refill( mag );
+        }
+
+#ifdef PROMISE_POOL_STATISTICS
+        mag.m_creates++;
+#endif
+
+        // Construct new object in a cached cell
+        void* cell= mag.m_cells[ --mag.m_count ];
+        return new(cell) T_Element( std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create a pooled object, that gets this array passed as its deallocator
+     */
+    template< typename T_Element, typename ... T_Args >
+    T_Element* createPooled( T_Args&& ... args ) {
+        return create<T_Element>( static_cast<Deallocator*>( this ), std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create multiple objects at once from the magazine, which is refilled as needed
+     * Every object is constructed from copies of the same arguments
+     */
+    template< typename T_Element, typename ... T_Args >
+    void createN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        auto& mag= getMagazine();
+
+        for( std::size_t i= 0; i!= num; i++ ) {
+            // Refill half of the magazine from the shared array if it is empty
+            if( !mag.m_count ) {
+                refill( mag );
+            }
+
+            objects[i]= new( mag.m_cells[ --mag.m_count ] ) T_Element( args... );
+        }
+
+#ifdef PROMISE_POOL_STATISTICS
+        mag.m_creates+= num;
+#endif
+    }
+
+    template< typename T_Element, typename ... T_Args >
+    void createPooledN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        createN<T_Element>( objects, num, static_cast<Deallocator*>( this ), args... );
+    }
+
+    template< typename T_Element >
+    void free( T_Element* ptr ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        Deallocator::free( ptr );
+    }
+
+    template< typename T_Element >
+    void freeN( T_Element* const* ptrs, const std::size_t num ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        Deallocator::freeN( ptrs, num );
+    }
+
+    /**
+     * Fetch a single uninitialized cell from the magazine
+     */
+    void* allocateCell() {
+        auto& mag= getMagazine();
+
+        if( !mag.m_count ) {
+            refill( mag );
+        }
+
+#ifdef PROMISE_POOL_STATISTICS
+        mag.m_creates++;
+#endif
+
+        return mag.m_cells[ --mag.m_count ];
+    }
+
+    /**
+     * Return a cell fetched by 'allocateCell' to the magazine
+     */
+    void freeCell( void* ptr ) {
+        deallocate( ptr );
+    }
+
+    /**
+     * Return all cells cached by the calling thread to the shared array
+     */
+    void flushThreadCache() {
+        auto mag= CachedObjectPoolDetail::ThreadCache::find( m_id );
+        if( !mag ) {
+            return;
+        }
+
+        flushMagazine( *mag );
+        CachedObjectPoolDetail::ThreadCache::remove( m_id );
+    }
+
+    /**
+     * Release the empty blocks of the shared array
+     * Cells cached by threads keep their blocks alive
+     */
+    std::size_t trim() {
+        return m_shared.trim();
+    }
+
+    void setAutoTrim( const float watermark, const std::size_t delay ) {
+        m_shared.setAutoTrim( watermark, delay );
+    }
+
+    void reserve( const std::size_t num ) {
+        m_shared.reserve( num );
+    }
+
+    std::size_t capacity() const {
+        return m_shared.capacity();
+    }
+
+    /**
+     * Number of empty cells in the shared array, not counting the cached ones
+     */
+    std::size_t space() const {
+        return m_shared.space();
+    }
+
+    /**
+     * Number of cells handed out by the shared array, including the cached ones
+     */
+    std::size_t usage() const {
+        return m_shared.usage();
+    }
+
+    std::size_t peakUsage() const {
+        return m_shared.peakUsage();
+    }
+
+    /**
+     * Take a snapshot of the statistics
+     * Creates and frees are counted per thread and only show up once a magazine
+     * is refilled, spilled or flushed. The usage includes the cached cells
+     */
+    PoolStatistics statistics() {
+        auto stats= m_shared.statistics();
+
+#ifdef PROMISE_POOL_STATISTICS
+        stats.m_creates= m_creates.load( std::memory_order_relaxed );
+        stats.m_frees= m_frees.load( std::memory_order_relaxed );
+        stats.m_cacheRefills= m_refills.load( std::memory_order_relaxed );
+        stats.m_cacheSpills= m_spills.load( std::memory_order_relaxed );
+#endif
+
+        return stats;
+    }
+};
+
+
+/**
+ * Templated Cached Object Pool Class
+ * Like its parent it holds objects of arbitrary type in a pool
+ * It is synchronised like a SyncObjectPool, but serves most
+ * requests from a per-thread cache
+ *
+ * @tparam T_Elements - Pack of types to be stored
+ */
+template<typename ... T_Elements>
+class CachedObjectPool : public CachedAllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
+                                                  ObjectPoolDetail::requiredAlign<T_Elements...>::value > {
+public:
+    explicit CachedObjectPool(const unsigned int s, BlockSource& src= BlockSource::heap())
+            : CachedAllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
+                                ObjectPoolDetail::requiredAlign<T_Elements...>::value >( s, src ) {}
+
+};
+
+
+#endif //PROMISE_CACHEDOBJECTPOOL_H
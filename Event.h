@@ -8,14 +8,16 @@
 #include <memory>
 #include "LambdaContainer.h"
 #include "ObjectPool.h"
+#include "MpscEventQueue.h"
 
 class EventLoop;
 
 /**
  * Abstract Event Class
  * Interface for code to be run on the event loop thread
+ * Events link themselves into the queue of the event loop
  */
-class Event : public PooledObject {
+class Event : public PooledObject, public MpscQueueLink {
 private:
 
 public:
@@ -3,23 +3,67 @@
 //
 
 #include "EventLoop.h"
+#include "Timer.h"
 #include "Console.h"
 
-void EventLoop::sendEvent(PoolPointer<Event> ev) {
-    m_queue.push( std::move(ev) );
+void EventLoop::sendEvent(PoolPointer<Event> ev, Priority p) {
+    m_queue.push( std::move(ev), laneOf( p ) );
+}
+
+void EventLoop::sendEvents( PoolPointer<Event>* evs, std::size_t num, Priority p ) {
+    m_queue.pushN( evs, num, laneOf( p ) );
+}
+
+void EventLoop::wakeUp() {
+    m_queue.wakeUp();
+}
+
+void EventLoop::execute( PoolPointer<Event> ev ) {
+    m_currentEvent= std::move(ev);
+    m_currentEvent->execute( *this );
+
+    // Deallocate event object
+    m_currentEvent.reset( nullptr );
+
+    // Free the temporaries of the event
+    m_arena.reset();
+}
+
+void EventLoop::executeBatch( PoolPointer<Event>* evs, std::size_t num ) {
+    for( std::size_t i= 0; i!= num; i++ ) {
+        // Events behind a stop are dropped like the ones left in the queue
+        if( m_enable ) {
+            execute( std::move( evs[i] ) );
+        } else {
+            evs[i].reset( nullptr );
+        }
+    }
 }
 
 void EventLoop::run() {
     // Sanity check that the pointers are set
     checkSetup();
 
+    PoolPointer<Event> batch[ T_batchSize ];
+
     while( m_enable ) {
         //Console::println( "Waiting for events... " );
-        m_currentEvent= m_queue.waitForPop();
-        m_currentEvent->execute( *this );
+        if( !m_timerPtr->isInline() ) {
+            executeBatch( batch, m_queue.waitForPopN( batch, T_batchSize ) );
+            continue;
+        }
+
+        // Run the expired timer events directly on this thread
+        m_timerPtr->expireInline( [this]( PoolPointer<Event> e ) {
+            execute( std::move(e) );
+        } );
+
+        if( !m_enable ) {
+            break;
+        }
 
-        // Deallocate event object
-        m_currentEvent.reset( nullptr );
+        // Wait for an event, but not beyond the next timer deadline
+        executeBatch( batch, m_queue.waitForPopNUntil( m_timerPtr->nextDeadline(), batch, T_batchSize ) );
     }
 
     Console::println("Stopping event loop...");
@@ -7,8 +7,9 @@
 
 
 #include "Event.h"
-#include "EventQueue.h"
+#include "MpscEventQueue.h"
 #include "PoolDefs.h"
+#include "Arena.h"
 
 class WorkerPool;
 class Timer;
@@ -16,24 +17,39 @@ class Timer;
 /**
  * Event Loop Class
  * Contains the event queue which messages are executed on the main thread
+ * The queue is lock free, as only the loop thread takes events out of it
+ * Events are taken from the queue in batches and then executed in order
+ * Every priority has its own lane in the queue
+ * Events can allocate temporaries from the arena of the loop, which is reset
+ * after every event, except for the memory that is pinned
+ * If the timer is in inline mode the loop waits for its next deadline as
+ * well and runs expired timer events itself
  */
 class EventLoop {
 private:
-    EventQueue<Event> m_queue;
+    MpscEventQueue<Event, T_priorityCount> m_queue;
     WorkerPool* m_poolPtr;
     Timer *m_timerPtr;
 
     using T_Allocator= PoolAllocator< PoolDefs::T_EventPool >;
     T_Allocator& m_allocator;
 
+    static constexpr std::size_t T_arenaChunkSize= 64* 1024;
+    static constexpr std::size_t T_batchSize= 64;
+    Arena m_arena;
+
     PoolPointer<Event> m_currentEvent;
     bool m_enable;
 
     void checkSetup();
 
+    void execute( PoolPointer<Event> ev );
+
+    void executeBatch( PoolPointer<Event>* evs, std::size_t num );
+
 public:
     EventLoop( T_Allocator& alloc )
-            : m_poolPtr(nullptr), m_timerPtr(nullptr), m_allocator(alloc), m_enable(true) {}
+            : m_poolPtr(nullptr), m_timerPtr(nullptr), m_allocator(alloc), m_arena(T_arenaChunkSize), m_enable(true) {}
 
     inline void setWorkers( WorkerPool& p ) { m_poolPtr= &p; }
 
@@ -45,13 +61,41 @@ public:
 
     inline T_Allocator& getAlloc() { return m_allocator; }
 
+    inline Arena& getArena() { return m_arena; }
+
     inline PoolPointer<Event> getEventHandle() { return std::move(m_currentEvent); }
 
     void stop() {
         m_enable= false;
     }
 
-    void sendEvent( PoolPointer<Event> ev );
+    void sendEvent( PoolPointer<Event> ev, Priority p= Priority::Normal );
+
+    inline std::size_t getQueueDepth() const {
+        return m_queue.getDepth();
+    }
+
+    /**
+     * How long the loop keeps looking for events before it parks
+     */
+    inline void setWaitPolicy( const WaitPolicy& p ) {
+        m_queue.setWaitPolicy( p );
+    }
+
+    inline WaitPolicy getWaitPolicy() const {
+        return m_queue.getWaitPolicy();
+    }
+
+    /**
+     * Send multiple events at once, which are moved out of the array
+     */
+    void sendEvents( PoolPointer<Event>* evs, std::size_t num, Priority p= Priority::Normal );
+
+    /**
+     * Interrupt the wait for the next event, so that the deadline of an
+     * inline timer is looked up again
+     */
+    void wakeUp();
 
     void run();
 };
@@ -7,50 +7,284 @@
 
 #include <mutex>
 #include <queue>
+#include <atomic>
+#include <deque>
+#include <vector>
 #include <condition_variable>
 
 #include "ObjectPool.h"
+#include "PoolStdAllocator.h"
+#include "Priority.h"
+#include "SpinWait.h"
+
+/**
+ * Behaviour of a bounded event queue when an element is pushed while it is full
+ * Block:      The producer waits until a consumer made room
+ * Reject:     The new element is handed back to the producer
+ * DropOldest: The oldest element of the last lane is removed and handed back to
+ *             the producer. If that lane is before the one of the new element,
+ *             the new element is handed back instead
+ */
+enum class QueuePolicy {
+    Block,
+    Reject,
+    DropOldest
+};
 
 /**
  * Templated Atomic Event Queue Class
  *
  * Allows atomically queueing of unique pointers to objects of type T_Event
  * Synchronization is achieved through a single mutex
- * Threads are set to sleep with a condition variable if the queue is currently
- * empty
+ * Consumers of an empty queue first poll its depth without the lock according to
+ * the wait policy, and only then sleep on a condition variable. Producers skip the
+ * notification if no consumer sleeps
+ * The storage of the queue is taken from a pool instead of the heap
+ * The queue can be bounded by a capacity, whose overflow is handled by the
+ * queue policy. The current depth can be read without taking the lock
+ * Elements can be pushed into multiple lanes, which are popped according to a
+ * lane scheduler: Earlier lanes are preferred, but later ones do not starve.
+ * The capacity is shared by all lanes
  *
  * @tparam T_Event - Type of event to be referenced
+ * @tparam T_laneCount - Number of lanes
+ * @tparam T_StorageAlloc - Allocator for the storage of the queue
  */
-template < typename T_Event >
+template < typename T_Event, unsigned int T_laneCount= 1, typename T_StorageAlloc= PoolStdAllocator< PoolPointer< T_Event > > >
 class EventQueue {
 private:
+    using T_Container= std::deque< PoolPointer< T_Event >, T_StorageAlloc >;
+    using T_Queue= std::queue< PoolPointer< T_Event >, T_Container >;
+
     std::mutex m_mutex;
     std::condition_variable m_cvar;
+    bool m_wakeUp;
+
+    // Number of consumers sleeping on the condition variable
+    unsigned int m_waiting;
+    SpinWait m_spinWait;
+
+    // Bound of the queue, zero if unbounded
+    const std::size_t m_capacity;
+    const QueuePolicy m_policy;
+    std::condition_variable m_spaceCvar;
+    unsigned int m_blocked;
+    std::atomic< std::size_t > m_depth;
+    std::atomic< std::size_t > m_laneDepths[ T_laneCount ];
 
-    std::queue< PoolPointer< T_Event > > m_queue;
+    T_StorageAlloc m_storageAlloc;
+    T_Queue m_queues[ T_laneCount ];
+    std::size_t m_size;
+    LaneScheduler< T_laneCount > m_scheduler;
+
+    /**
+     * Update the depth after elements were removed and let blocked producers in
+     */
+    void removed( const std::size_t num ) {
+        m_depth.store( m_size, std::memory_order_relaxed );
+
+        if( m_blocked && num ) {
+            if( num == 1 ) {
+                m_spaceCvar.notify_one();
+            } else {
+                m_spaceCvar.notify_all();
+            }
+        }
+    }
+
+    PoolPointer<T_Event> unsafeTake( const unsigned int lane ) {
+        auto& q= m_queues[ lane ];
+        auto p= std::move( q.front() );
+        q.pop();
+
+        m_size--;
+        m_laneDepths[ lane ].store( q.size(), std::memory_order_relaxed );
+        return p;
+    }
 
     PoolPointer<T_Event> unsafePop()  {
-        if( m_queue.empty() ) {
+        const auto lane= m_scheduler.next( [this]( const unsigned int i ) { return m_queues[i].empty(); } );
+        if( lane == T_laneCount ) {
             return nullptr;
         }
 
-        auto p= std::move( m_queue.front() );
-        m_queue.pop();
+        auto p= unsafeTake( lane );
+        removed( 1 );
         return p;
     }
 
-    void unsafePush(PoolPointer<T_Event> p) {
-        m_queue.emplace( std::move( p ) );
-        m_cvar.notify_one();
+    void unsafeEmplace( PoolPointer<T_Event> p, const unsigned int lane ) {
+        auto& q= m_queues[ lane ];
+        q.emplace( std::move( p ) );
+
+        m_size++;
+        m_laneDepths[ lane ].store( q.size(), std::memory_order_relaxed );
+        m_depth.store( m_size, std::memory_order_relaxed );
+    }
+
+    /**
+     * Enqueue the element according to the policy, the lock is released while blocking
+     * @return Element that did not fit into the queue
+     */
+    PoolPointer<T_Event> unsafePush( std::unique_lock<std::mutex>& lock, PoolPointer<T_Event> p, const unsigned int lane ) {
+        PoolPointer<T_Event> overflow;
+
+        if( m_capacity && m_size >= m_capacity ) {
+            switch( m_policy ) {
+                case QueuePolicy::Block:
+                    m_blocked++;
+                    m_spaceCvar.wait( lock, [this]() { return m_size < m_capacity; } );
+                    m_blocked--;
+                    break;
+
+                case QueuePolicy::Reject:
+                    return p;
+
+                case QueuePolicy::DropOldest: {
+                    // Drop from the last lane, but never in favour of a later element
+                    auto last= T_laneCount- 1;
+                    while( m_queues[ last ].empty() ) {
+                        last--;
+                    }
+
+                    if( last < lane ) {
+                        return p;
+                    }
+
+                    overflow= unsafeTake( last );
+                    break;
+                }
+            }
+        }
+
+        unsafeEmplace( std::move( p ), lane );
+        return overflow;
+    }
+
+    /**
+     * Poll without the lock before a consumer takes it and maybe has to sleep
+     */
+    inline void spin() {
+        m_spinWait.wait( [this]() { return getDepth() > 0; } );
+    }
+
+    inline void sleep( std::unique_lock<std::mutex>& lock ) {
+        m_waiting++;
+        m_cvar.wait( lock );
+        m_waiting--;
+    }
+
+    template< typename T_TimePoint >
+    inline std::cv_status sleepUntil( std::unique_lock<std::mutex>& lock, const T_TimePoint& t ) {
+        m_waiting++;
+        const auto status= m_cvar.wait_until( lock, t );
+        m_waiting--;
+        return status;
+    }
+
+    inline void notify( const std::size_t num ) {
+        if( !m_waiting ) {
+            return;
+        }
+
+        if( num == 1 ) {
+            m_cvar.notify_one();
+        } else {
+            m_cvar.notify_all();
+        }
+    }
+
+    std::size_t unsafePopN( PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        std::size_t num= 0;
+        for( ; num!= max && (ptrs[num]= unsafePop()); num++ ) {}
+
+        return num;
     }
 
 public:
-    EventQueue() = default;
+    /**
+     * @param capacity - Max number of elements to store: zero for an unbounded queue
+     * @param policy - Behaviour when pushing while the queue is full
+     */
+    explicit EventQueue( const std::size_t capacity= 0, const QueuePolicy policy= QueuePolicy::Block,
+                         const T_StorageAlloc& alloc= T_StorageAlloc() )
+            : m_wakeUp( false ), m_waiting( 0 ), m_capacity( capacity ), m_policy( policy ), m_blocked( 0 ), m_depth( 0 ),
+              m_storageAlloc( alloc ), m_size( 0 ) {
+        for( unsigned int i= 0; i!= T_laneCount; i++ ) {
+            T_Queue( T_Container( alloc ) ).swap( m_queues[i] );
+            m_laneDepths[i].store( 0, std::memory_order_relaxed );
+        }
+    }
 
-    void push(PoolPointer<T_Event> p)  {
-        std::lock_guard<std::mutex> lock( m_mutex );
+    /**
+     * Number of elements currently queued
+     * Does not take the lock, so it is only a snapshot while other threads use the queue
+     */
+    inline std::size_t getDepth() const {
+        return m_depth.load( std::memory_order_relaxed );
+    }
+
+    inline std::size_t getDepth( const unsigned int lane ) const {
+        return m_laneDepths[ lane ].load( std::memory_order_relaxed );
+    }
+
+    inline std::size_t getCapacity() const {
+        return m_capacity;
+    }
 
-        unsafePush( std::move(p) );
+    inline QueuePolicy getPolicy() const {
+        return m_policy;
+    }
+
+    /**
+     * Can be changed while consumers wait
+     */
+    inline void setWaitPolicy( const WaitPolicy& p ) {
+        m_spinWait.setPolicy( p );
+    }
+
+    inline WaitPolicy getWaitPolicy() const {
+        return m_spinWait.getPolicy();
+    }
+
+    /**
+     * Push an element, which might block or overflow if the queue is bounded
+     * @return Element that did not fit into the queue, which is either the provided
+     *         one or the oldest queued one, depending on the policy
+     */
+    PoolPointer<T_Event> push(PoolPointer<T_Event> p, const unsigned int lane= 0)  {
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        auto overflow= unsafePush( lock, std::move(p), lane );
+        notify( 1 );
+        return overflow;
+    }
+
+    /**
+     * Push multiple elements while holding the lock only a single time
+     * The elements are moved out of the array, elements that did not fit into the
+     * queue are moved back to the front of the array
+     * @return Number of elements that did not fit into the queue
+     */
+    std::size_t pushN( PoolPointer<T_Event>* ptrs, const std::size_t num, const unsigned int lane= 0 ) {
+        if( !num ) {
+            return 0;
+        }
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        std::size_t numOverflow= 0;
+        for( std::size_t i= 0; i!= num; i++ ) {
+            // Never overwrites an element that was not pushed yet, as at most one element overflows per push
+            if( auto overflow= unsafePush( lock, std::move( ptrs[i] ), lane ) ) {
+                ptrs[ numOverflow++ ]= std::move( overflow );
+            }
+        }
+
+        // Wake up as many consumers as there are new elements
+        notify( num );
+
+        return numOverflow;
     }
 
     PoolPointer<T_Event> pop()  {
@@ -59,25 +293,135 @@ public:
         return unsafePop();
     }
 
+    /**
+     * Take the oldest element of a single lane, bypassing the lane scheduler
+     */
+    PoolPointer<T_Event> popLane( const unsigned int lane ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        if( m_queues[ lane ].empty() ) {
+            return nullptr;
+        }
+
+        auto p= unsafeTake( lane );
+        removed( 1 );
+        return p;
+    }
+
+    /**
+     * Move up to 'max' elements into the array while holding the lock only a single time
+     * @return Number of elements taken
+     */
+    std::size_t popN( PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        return unsafePopN( ptrs, max );
+    }
+
+    /**
+     * Move all elements to the back of the container while holding the lock only a single time
+     * @return Number of elements taken
+     */
+    template< typename T_Batch >
+    std::size_t popAll( T_Batch& batch ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        const auto num= m_size;
+        while( auto p= unsafePop() ) {
+            batch.push_back( std::move( p ) );
+        }
+
+        return num;
+    }
+
+    /**
+     * Wait until there is at least a single element, then take up to 'max' elements
+     * @return Number of elements taken
+     */
+    std::size_t waitForPopN( PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        spin();
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        while( !m_size ) {
+            sleep( lock );
+        }
+
+        return unsafePopN( ptrs, max );
+    }
+
     PoolPointer<T_Event> waitForPop() {
+        spin();
+        std::unique_lock<std::mutex> lock( m_mutex );
+        PoolPointer<T_Event> p;
+
+        while( (p= this->unsafePop()) == nullptr ) {
+            sleep( lock );
+        }
+
+        return p;
+    }
+
+    /**
+     * Wait for an element until the provided point in time
+     * Returns early without an element if 'wakeUp' is called
+     */
+    template< typename T_TimePoint >
+    PoolPointer<T_Event> waitForPopUntil( const T_TimePoint& t ) {
+        spin();
         std::unique_lock<std::mutex> lock( m_mutex );
         PoolPointer<T_Event> p;
 
         while( (p= this->unsafePop()) == nullptr ) {
-            m_cvar.wait( lock );
+            if( m_wakeUp ) {
+                break;
+            }
+
+            // Do not pass the maximum time point on, as it might overflow
+            if( t == T_TimePoint::max() ) {
+                sleep( lock );
+
+            } else if( sleepUntil( lock, t ) == std::cv_status::timeout ) {
+                p= this->unsafePop();
+                break;
+            }
         }
 
+        m_wakeUp= false;
         return p;
     }
 
+    /**
+     * Make the current or next call of 'waitForPopUntil' return
+     */
+    void wakeUp() {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_wakeUp= true;
+        notify( 2 );
+    }
+
+    /**
+     * Destroy all queued elements and fill the first lane with new objects
+     * The capacity is ignored, so the new objects always get in
+     */
     template< typename T, typename T_Alloc >
     void replace( T_Alloc& alloc, unsigned int num ) {
+        // Create all new objects up front as a single batch
+        std::vector< PoolPointer<T> > objects( num );
+        alloc.template allocateN<T>( objects.data(), num );
+
         std::lock_guard<std::mutex> lock( m_mutex );
-        std::queue<PoolPointer<T_Event>>().swap( m_queue );
+        for( unsigned int i= 0; i!= T_laneCount; i++ ) {
+            T_Queue( T_Container( m_storageAlloc ) ).swap( m_queues[i] );
+            m_laneDepths[i].store( 0, std::memory_order_relaxed );
+        }
+        m_size= 0;
 
-        for( ; num; num-- ) {
-            unsafePush( alloc.template allocate<T>() );
+        for( auto& p : objects ) {
+            unsafeEmplace( std::move( p ), 0 );
         }
+
+        notify( num );
+        m_spaceCvar.notify_all();
     }
 };
 
@@ -200,6 +200,30 @@ namespace FileSystem {
         }
     }
 
+    void Detail::FileLoaderTask::reject(EventLoop &l) {
+        if( m_callbackReject ) {
+            m_callbackReject->getData<0>()= std::move( m_path );
+            m_callbackReject->getData<1>()= T_queueFullError;
+            l.sendEvent(std::move( m_callbackReject ));
+        }
+    }
+
+    void Detail::StrFileLoaderTask::reject(EventLoop &l) {
+        if( m_callbackReject ) {
+            m_callbackReject->getData<0>()= m_path;
+            m_callbackReject->getData<1>()= T_queueFullError;
+            l.sendEvent(std::move( m_callbackReject ));
+        }
+    }
+
+    void Detail::FileReaderTask::reject(EventLoop &l) {
+        if( m_callbackReject ) {
+            m_callbackReject->getData<0>()= std::move( m_file );
+            m_callbackReject->getData<1>()= T_queueFullError;
+            l.sendEvent(std::move( m_callbackReject ));
+        }
+    }
+
     void Detail::FileReaderTask::execute(Worker::WorkerInterface &intf) {
         if( !m_callbackResolve ) {
             return;
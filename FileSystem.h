@@ -104,6 +104,8 @@ namespace FileSystem {
                     : Promise(d), m_path( std::move(p) ), m_buffer( std::move(b) ), m_mode( m ) {}
 
             void execute( Worker::WorkerInterface& ) override;
+
+            void reject( EventLoop& l ) override;
         };
 
         /**
@@ -121,6 +123,8 @@ namespace FileSystem {
                     : Promise(d), m_path( p ), m_buffer( std::move(b) ), m_mode( m ) {}
 
             void execute( Worker::WorkerInterface& ) override;
+
+            void reject( EventLoop& l ) override;
         };
 
         /**
@@ -137,6 +141,8 @@ namespace FileSystem {
                     : Promise(d), m_file( std::move(f) ), m_buffer( std::move(b) ), m_length( l ) {}
 
             void execute( Worker::WorkerInterface& ) override;
+
+            void reject( EventLoop& l ) override;
         };
 
     }
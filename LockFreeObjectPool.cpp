@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 16.09.2019.
+//
+
+#include "LockFreeObjectPool.h"
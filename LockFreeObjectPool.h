@@ -0,0 +1,339 @@
+//
+// Created by Matthias Preymann on 16.09.2019.
+//
+
+#ifndef PROMISE_LOCKFREEOBJECTPOOL_H
+#define PROMISE_LOCKFREEOBJECTPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include "ObjectPool.h"
+
+
+/**
+ * Templated Lock Free Allocation Array Class
+ * Stores objects that satisfy the size and alignment specifications like
+ * an AllocArray, but creation and deletion of objects do not take a lock
+ * Empty cells are kept in an intrusive Treiber stack, whose head is a tagged
+ * pointer: The upper bits of the head word hold a counter that is incremented
+ * on every modification, so a head that was popped and pushed again in between
+ * (ABA) makes the compare-and-swap fail
+ * Only adding a new block takes a mutex. Blocks are never released before the
+ * array is destroyed, as other threads might still read the link of a cell they
+ * have just lost to a faster thread
+ *
+ * @tparam T_CellSize - maximal needed cell size
+ * @tparam T_CellAlign - maximal needed cell alignment
+ */
+template< std::size_t T_CellSize, std::size_t T_CellAlign >
+class LockFreeAllocArray : public Deallocator {
+private:
+
+    /**
+     * Internal Free Cell Struct
+     * Overlays an empty cell to link it into the stack
+     */
+    struct FreeCell {
+        std::atomic< FreeCell* > m_next;
+    };
+
+    // Every cell has to be able to hold a stack link
+    static constexpr std::size_t T_StorageSize=  T_CellSize  > sizeof(FreeCell)  ? T_CellSize  : sizeof(FreeCell);
+    static constexpr std::size_t T_StorageAlign= T_CellAlign > alignof(FreeCell) ? T_CellAlign : alignof(FreeCell);
+
+    using T_Cell= typename std::aligned_storage< T_StorageSize, T_StorageAlign >::type;
+
+    // User space addresses fit into 48 bits on 64bit platforms, which leaves 16 bits for the tag
+    static constexpr unsigned int T_pointerBits= sizeof(void*) == 8 ? 48 : 32;
+    static constexpr std::uint64_t T_pointerMask= (std::uint64_t(1) << T_pointerBits) - 1;
+
+    static_assert( std::atomic< std::uint64_t >::is_always_lock_free, "Tagged stack head has to be lock free." );
+
+    std::atomic< std::uint64_t > m_head;
+    std::atomic< std::size_t > m_freeCount;
+
+    std::mutex m_growMutex;
+    SmallStack< T_Cell* > m_blocks;
+
+    BlockSource& m_source;
+    const unsigned int m_blockSize;
+
+    static inline std::uint64_t pack( FreeCell* const p, const std::uint64_t tag ) {
+        return (static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>(p) ) & T_pointerMask) | (tag << T_pointerBits);
+    }
+
+    static inline FreeCell* pointerOf( const std::uint64_t w ) {
+        return reinterpret_cast<FreeCell*>( static_cast<std::uintptr_t>( w & T_pointerMask ) );
+    }
+
+    static inline std::uint64_t tagOf( const std::uint64_t w ) {
+        return w >> T_pointerBits;
+    }
+
+    void pushChain( FreeCell* const first, FreeCell* const last, const std::size_t num ) {
+        auto head= m_head.load( std::memory_order_relaxed );
+
+        // Link the chain in front of the current head and swap it in with a new tag
+        do {
+            last->m_next.store( pointerOf( head ), std::memory_order_relaxed );
+        } while( !m_head.compare_exchange_weak( head, pack( first, tagOf( head )+ 1 ),
+                                                std::memory_order_release, std::memory_order_relaxed ) );
+
+        m_freeCount.fetch_add( num, std::memory_order_relaxed );
+    }
+
+    FreeCell* tryPop() {
+        auto head= m_head.load( std::memory_order_acquire );
+
+        while( pointerOf( head ) ) {
+            // The link might be stale if another thread took the cell meanwhile, the tag catches that
+            auto next= pointerOf( head )->m_next.load( std::memory_order_relaxed );
+
+            if( m_head.compare_exchange_weak( head, pack( next, tagOf( head )+ 1 ),
+                                              std::memory_order_acquire, std::memory_order_acquire ) ) {
+                m_freeCount.fetch_sub( 1, std::memory_order_relaxed );
+                return pointerOf( head );
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Pop a chain of up to 'max' cells with a single compare-and-swap
+     * @return Number of cells taken, zero if the stack is empty
+     */
+    template< typename T >
+    std::size_t tryPopN( T** cells, const std::size_t max ) {
+        if( !max ) {
+            return 0;
+        }
+
+        auto head= m_head.load( std::memory_order_acquire );
+
+        while( pointerOf( head ) ) {
+            // A link is only followed while the head is unchanged, as its cell might be in use
+            // by another thread already, which overwrote the link with object data
+            auto next= pointerOf( head );
+            auto current= head;
+            std::size_t num= 0;
+            while( num!= max && next && current == head ) {
+                cells[num++]= reinterpret_cast<T*>( next );
+                next= next->m_next.load( std::memory_order_acquire );
+                current= m_head.load( std::memory_order_acquire );
+            }
+
+            if( current != head ) {
+                head= current;
+                continue;
+            }
+
+            if( m_head.compare_exchange_weak( head, pack( next, tagOf( head )+ 1 ),
+                                              std::memory_order_acquire, std::memory_order_acquire ) ) {
+                m_freeCount.fetch_sub( num, std::memory_order_relaxed );
+                return num;
+            }
+        }
+
+        return 0;
+    }
+
+    FreeCell* grow() {
+        std::lock_guard<std::mutex> lock( m_growMutex );
+
+        // Another thread might have added a block in the meantime
+        if( auto cell= tryPop() ) {
+            return cell;
+        }
+
+        // Create new block of cells without initializing them
+        auto cells= static_cast<T_Cell*>( m_source.allocateBlock( sizeof(T_Cell)* m_blockSize, alignof(T_Cell) ) );
+
+        if( static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( cells+ m_blockSize ) ) > T_pointerMask ) {
+            m_source.releaseBlock( cells, sizeof(T_Cell)* m_blockSize, alignof(T_Cell) );
+            throw std::runtime_error("Block address cannot be stored as tagged pointer.");
+        }
+
+        // Keep the first cell for the caller and link up all the others
+        for( unsigned int i= 1; i< m_blockSize; i++ ) {
+            auto cell= new( cells+ i ) FreeCell;
+            cell->m_next.store( (i+1 < m_blockSize) ? reinterpret_cast<FreeCell*>( cells+ i+ 1 ) : nullptr,
+                                std::memory_order_relaxed );
+        }
+
+        m_blocks.push( cells );
+
+        if( m_blockSize > 1 ) {
+            pushChain( reinterpret_cast<FreeCell*>( cells+ 1 ), reinterpret_cast<FreeCell*>( cells+ m_blockSize- 1 ), m_blockSize- 1 );
+        }
+
+        return reinterpret_cast<FreeCell*>( cells );
+    }
+
+protected:
+    void deallocate( void* ptr ) override {
+        // Return the cell
+        auto cell= new(ptr) FreeCell;
+        pushChain( cell, cell, 1 );
+    }
+
+    void deallocateCells( void* const* cells, const std::size_t num ) override {
+        if( !num ) {
+            return;
+        }
+
+        // Link all cells up to a chain and push it at once
+        auto first= new( cells[0] ) FreeCell;
+        auto last= first;
+        for( std::size_t i= 1; i!= num; i++ ) {
+            auto cell= new( cells[i] ) FreeCell;
+            last->m_next.store( cell, std::memory_order_relaxed );
+            last= cell;
+        }
+
+        pushChain( first, last, num );
+    }
+
+public:
+    explicit LockFreeAllocArray( const unsigned int s, BlockSource& src= BlockSource::heap() )
+            : m_head( 0 ), m_freeCount( 0 ), m_source( src ), m_blockSize( s ) {
+        if( !m_blockSize ) {
+            throw std::runtime_error("Block size of Lock Free Object Pool cannot be zero.");
+        }
+
+        // Add the initial block
+        deallocate( grow() );
+    }
+
+    LockFreeAllocArray( const LockFreeAllocArray& )= delete;
+
+    ~LockFreeAllocArray() {
+        while( !m_blocks.isEmpty() ) {
+            m_source.releaseBlock( m_blocks.top(), sizeof(T_Cell)* m_blockSize, alignof(T_Cell) );
+            m_blocks.pop();
+        }
+    }
+
+    template< typename T_Element, typename ... T_Args >
+    T_Element* create( T_Args&& ... args ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        // Only take the lock if the stack is empty
+        FreeCell* cell= tryPop();
+        if( !cell ) {
+            cell= grow();
+        }
+
+        // Construct new object in the empty cell
+        return new(cell) T_Element( std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create a pooled object, that gets this array passed as its deallocator
+     */
+    template< typename T_Element, typename ... T_Args >
+    T_Element* createPooled( T_Args&& ... args ) {
+        return create<T_Element>( static_cast<Deallocator*>( this ), std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create multiple objects at once, whose cells are popped with a single
+     * compare-and-swap as long as the stack holds enough of them
+     * Every object is constructed from copies of the same arguments
+     */
+    template< typename T_Element, typename ... T_Args >
+    void createN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        // Only take the lock if the stack runs empty
+        for( std::size_t i= 0; i!= num; ) {
+            if( auto n= tryPopN( objects+ i, num- i ) ) {
+                i+= n;
+            } else {
+                objects[i++]= reinterpret_cast<T_Element*>( grow() );
+            }
+        }
+
+        // Construct the new objects in the empty cells
+        for( std::size_t i= 0; i!= num; i++ ) {
+            objects[i]= new(objects[i]) T_Element( args... );
+        }
+    }
+
+    template< typename T_Element, typename ... T_Args >
+    void createPooledN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        createN<T_Element>( objects, num, static_cast<Deallocator*>( this ), args... );
+    }
+
+    template< typename T_Element >
+    void free( T_Element* ptr ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        // Destruct the object
+        ptr->~T_Element();
+
+        deallocate( ptr );
+    }
+
+    /**
+     * Destruct multiple objects and return them with a single push
+     */
+    template< typename T_Element >
+    void freeN( T_Element* const* ptrs, const std::size_t num ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        Deallocator::freeN( ptrs, num );
+    }
+
+    /**
+     * Fetch a single uninitialized cell
+     */
+    void* allocateCell() {
+        FreeCell* cell= tryPop();
+        return cell ? cell : grow();
+    }
+
+    /**
+     * Return a cell fetched by 'allocateCell' without running any destructor
+     */
+    void freeCell( void* ptr ) {
+        deallocate( ptr );
+    }
+
+    /**
+     * Number of empty cells
+     * Only a snapshot, as other threads might create or free objects concurrently
+     */
+    std::size_t space() const {
+        return m_freeCount.load( std::memory_order_relaxed );
+    }
+};
+
+
+/**
+ * Templated Lock Free Object Pool Class
+ * Like its parent it holds objects of arbitrary type in a pool
+ * Creation and deletion of objects is synchronised without locks
+ *
+ * @tparam T_Elements - Pack of types to be stored
+ */
+template<typename ... T_Elements>
+class LockFreeObjectPool : public LockFreeAllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
+                                                      ObjectPoolDetail::requiredAlign<T_Elements...>::value > {
+public:
+    explicit LockFreeObjectPool(const unsigned int s, BlockSource& src= BlockSource::heap())
+            : LockFreeAllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
+                                  ObjectPoolDetail::requiredAlign<T_Elements...>::value >( s, src ) {}
+
+};
+
+
+#endif //PROMISE_LOCKFREEOBJECTPOOL_H
@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 04.10.2019.
+//
+
+#include "MpscEventQueue.h"
@@ -0,0 +1,398 @@
+//
+// Created by Matthias Preymann on 04.10.2019.
+//
+
+#ifndef PROMISE_MPSCEVENTQUEUE_H
+#define PROMISE_MPSCEVENTQUEUE_H
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
+
+#include "ObjectPool.h"
+#include "Priority.h"
+#include "SpinWait.h"
+
+template< typename T_Event, unsigned int T_laneCount >
+class MpscEventQueue;
+
+/**
+ * Mpsc Queue Link Class
+ * Base class of objects that can be queued in a MpscEventQueue without
+ * any allocation. An object can only be in a single queue at a time
+ */
+class MpscQueueLink {
+private:
+    template< typename T_Event, unsigned int T_laneCount >
+    friend class MpscEventQueue;
+
+    std::atomic< MpscQueueLink* > m_next;
+
+public:
+    MpscQueueLink()
+            : m_next( nullptr ) {}
+
+    MpscQueueLink( const MpscQueueLink& )
+            : m_next( nullptr ) {}
+
+    MpscQueueLink& operator=( const MpscQueueLink& ) {
+        return *this;
+    }
+};
+
+
+/**
+ * Templated Multi Producer Single Consumer Event Queue Class
+ *
+ * Allows queueing of unique pointers to objects of type T_Event from any number
+ * of threads, while only a single thread takes them out again
+ * The queue is intrusive: The queued objects are linked through their own
+ * MpscQueueLink base, so pushing never allocates and never takes a lock. A
+ * producer appends by swapping the tail pointer and then linking its object
+ * to the previous one, so producers never wait for each other. A stub link
+ * keeps the queue from ever becoming entirely empty
+ * The consumer only parks on the condition variable if the queue stays empty
+ * while it spins according to the wait policy. It announces parking with a flag,
+ * which producers check after pushing, so the mutex is only taken when the
+ * consumer actually has to be woken up
+ * The queue is unbounded, but its current depth is counted
+ * Elements can be pushed into multiple lanes, which are popped according to a
+ * lane scheduler: Earlier lanes are preferred, but later ones do not starve
+ * Objects that are still queued are destroyed with the queue
+ *
+ * @tparam T_Event - Type of event to be referenced: has to derive from
+ *                   MpscQueueLink
+ * @tparam T_laneCount - Number of lanes
+ */
+template< typename T_Event, unsigned int T_laneCount= 1 >
+class MpscEventQueue {
+private:
+
+    /**
+     * Internal Lane Struct
+     * Producers swap in their objects at the tail, the consumer takes them from the head
+     */
+    struct Lane {
+        std::atomic< MpscQueueLink* > m_tail;
+        MpscQueueLink* m_head;
+        MpscQueueLink m_stub;
+
+        Lane()
+                : m_tail( &m_stub ), m_head( &m_stub ) {}
+
+        Lane( const Lane& )= delete;
+    };
+
+    Lane m_lanes[ T_laneCount ];
+    LaneScheduler< T_laneCount > m_scheduler;
+
+    // Incremented before pushing, so it never drops below zero
+    std::atomic< std::size_t > m_depth;
+
+    std::atomic< bool > m_parked;
+    std::atomic< bool > m_wakeUp;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cvar;
+    bool m_signaled;
+
+    SpinWait m_spinWait;
+
+    static inline MpscQueueLink* linkOf( T_Event* const e ) {
+        return static_cast< MpscQueueLink* >( e );
+    }
+
+    /**
+     * Append a chain of already linked objects with a single swap
+     */
+    static void pushChain( Lane& l, MpscQueueLink* const first, MpscQueueLink* const last ) {
+        last->m_next.store( nullptr, std::memory_order_relaxed );
+
+        // Until the link is set the consumer sees the lane as empty behind 'prev'
+        auto prev= l.m_tail.exchange( last, std::memory_order_acq_rel );
+        prev->m_next.store( first, std::memory_order_release );
+    }
+
+    /**
+     * Only a hint for the consumer, the lane might be empty even if it is not
+     * reported so, while a producer is still linking its object
+     */
+    static bool isEmpty( const Lane& l ) {
+        return l.m_head == &l.m_stub && !l.m_stub.m_next.load( std::memory_order_acquire );
+    }
+
+    /**
+     * Take the object at the head of the lane picked by the scheduler, returns nullptr
+     * if the queue is empty or the next objects are not linked completely yet
+     */
+    T_Event* unsafePop() {
+        const auto lane= m_scheduler.next( [this]( const unsigned int i ) { return isEmpty( m_lanes[i] ); } );
+        if( lane == T_laneCount ) {
+            return nullptr;
+        }
+
+        auto e= unsafeTake( m_lanes[ lane ] );
+
+        // Fall back to the other lanes if the object is not linked completely yet
+        for( unsigned int i= 0; !e && i!= T_laneCount; i++ ) {
+            e= unsafeTake( m_lanes[i] );
+        }
+
+        if( e ) {
+            m_depth.fetch_sub( 1, std::memory_order_relaxed );
+        }
+
+        return e;
+    }
+
+    static T_Event* unsafeTake( Lane& l ) {
+        auto head= l.m_head;
+        auto next= head->m_next.load( std::memory_order_acquire );
+
+        // Skip the stub
+        if( head == &l.m_stub ) {
+            if( !next ) {
+                return nullptr;
+            }
+
+            l.m_head= head= next;
+            next= head->m_next.load( std::memory_order_acquire );
+        }
+
+        if( next ) {
+            l.m_head= next;
+            return static_cast< T_Event* >( head );
+        }
+
+        // A producer has swapped the tail but not yet linked its object
+        if( head != l.m_tail.load( std::memory_order_acquire ) ) {
+            return nullptr;
+        }
+
+        // The head is the last object, put the stub behind it so it can be taken
+        pushChain( l, &l.m_stub, &l.m_stub );
+
+        next= head->m_next.load( std::memory_order_acquire );
+        if( next ) {
+            l.m_head= next;
+            return static_cast< T_Event* >( head );
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Wake up the consumer if it is parked
+     */
+    void signal() {
+        // Pairs with the fence of the consumer between setting the flag and checking the queue again
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( !m_parked.load( std::memory_order_relaxed ) ) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_signaled= true;
+        m_cvar.notify_one();
+    }
+
+    /**
+     * Park the consumer until it is signaled or the time point is reached
+     * @return Element that arrived after announcing to park
+     */
+    template< typename T_TimePoint >
+    T_Event* park( const T_TimePoint& t ) {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_parked.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        // Check again, as a producer might have missed the flag
+        T_Event* e= unsafePop();
+        if( !e && !m_wakeUp.load( std::memory_order_relaxed ) ) {
+            // Do not pass the maximum time point on, as it might overflow
+            if( t == T_TimePoint::max() ) {
+                m_cvar.wait( lock, [this]() { return m_signaled; } );
+
+            } else {
+                m_cvar.wait_until( lock, t, [this]() { return m_signaled; } );
+            }
+        }
+
+        m_signaled= false;
+        m_parked.store( false, std::memory_order_relaxed );
+        return e;
+    }
+
+public:
+    MpscEventQueue()
+            : m_depth( 0 ), m_parked( false ), m_wakeUp( false ), m_signaled( false ) {}
+
+    MpscEventQueue( const MpscEventQueue& )= delete;
+
+    ~MpscEventQueue() {
+        // Every popped element is destroyed right away
+        while( pop() ) {}
+    }
+
+    /**
+     * Number of elements currently queued
+     * Only a snapshot while other threads use the queue
+     */
+    inline std::size_t getDepth() const {
+        return m_depth.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * Can be changed while the consumer waits
+     */
+    inline void setWaitPolicy( const WaitPolicy& p ) {
+        m_spinWait.setPolicy( p );
+    }
+
+    inline WaitPolicy getWaitPolicy() const {
+        return m_spinWait.getPolicy();
+    }
+
+    /**
+     * Can be called by any thread
+     */
+    void push( PoolPointer<T_Event> p, const unsigned int lane= 0 ) {
+        m_depth.fetch_add( 1, std::memory_order_relaxed );
+        auto l= linkOf( p.release() );
+        pushChain( m_lanes[ lane ], l, l );
+        signal();
+    }
+
+    /**
+     * Push multiple elements with a single swap, so they stay in order and are not
+     * interleaved with the ones of other threads
+     * The elements are moved out of the array
+     */
+    template< typename T >
+    void pushN( PoolPointer<T>* ptrs, const std::size_t num, const unsigned int lane= 0 ) {
+        if( !num ) {
+            return;
+        }
+
+        m_depth.fetch_add( num, std::memory_order_relaxed );
+        auto first= linkOf( ptrs[0].release() );
+        auto last= first;
+        for( std::size_t i= 1; i!= num; i++ ) {
+            auto l= linkOf( ptrs[i].release() );
+            last->m_next.store( l, std::memory_order_relaxed );
+            last= l;
+        }
+
+        pushChain( m_lanes[ lane ], first, last );
+        signal();
+    }
+
+    /**
+     * Only to be called by the consumer thread
+     */
+    PoolPointer<T_Event> pop() {
+        return PoolPointer<T_Event>( unsafePop() );
+    }
+
+    /**
+     * Move up to 'max' elements into the array
+     * Only to be called by the consumer thread
+     * @return Number of elements taken
+     */
+    std::size_t popN( PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        std::size_t num= 0;
+        T_Event* e;
+
+        for( ; num!= max && (e= unsafePop()); num++ ) {
+            ptrs[num].reset( e );
+        }
+
+        return num;
+    }
+
+    /**
+     * Only to be called by the consumer thread
+     */
+    PoolPointer<T_Event> waitForPop() {
+        PoolPointer<T_Event> p;
+
+        while( !(p= waitForPopUntil( std::chrono::steady_clock::time_point::max() )) ) {}
+
+        return p;
+    }
+
+    /**
+     * Wait until there is at least a single element, then take up to 'max' elements
+     * Only to be called by the consumer thread
+     * @return Number of elements taken
+     */
+    std::size_t waitForPopN( PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        if( !max ) {
+            return 0;
+        }
+
+        ptrs[0]= waitForPop();
+        return 1+ popN( ptrs+ 1, max- 1 );
+    }
+
+    /**
+     * Wait for an element until the provided point in time
+     * Returns early without an element if 'wakeUp' is called
+     * Only to be called by the consumer thread
+     */
+    template< typename T_TimePoint >
+    PoolPointer<T_Event> waitForPopUntil( const T_TimePoint& t ) {
+        T_Event* e;
+
+        while( !(e= unsafePop()) ) {
+            if( m_wakeUp.load( std::memory_order_relaxed ) ) {
+                break;
+            }
+
+            // Only park if nothing arrives while spinning
+            if( m_spinWait.wait( [this]() { return getDepth() || m_wakeUp.load( std::memory_order_relaxed ); } ) ) {
+                continue;
+            }
+
+            e= park( t );
+            if( e || m_wakeUp.load( std::memory_order_relaxed ) ) {
+                break;
+            }
+
+            if( t != T_TimePoint::max() && T_TimePoint::clock::now() >= t ) {
+                e= unsafePop();
+                break;
+            }
+        }
+
+        m_wakeUp.store( false, std::memory_order_relaxed );
+        return PoolPointer<T_Event>( e );
+    }
+
+    /**
+     * Wait for the first element like 'waitForPopUntil', then take up to 'max' elements
+     * Only to be called by the consumer thread
+     * @return Number of elements taken
+     */
+    template< typename T_TimePoint >
+    std::size_t waitForPopNUntil( const T_TimePoint& t, PoolPointer<T_Event>* ptrs, const std::size_t max ) {
+        if( !max || !(ptrs[0]= waitForPopUntil( t )) ) {
+            return 0;
+        }
+
+        return 1+ popN( ptrs+ 1, max- 1 );
+    }
+
+    /**
+     * Make the current or next call of 'waitForPopUntil' return
+     */
+    void wakeUp() {
+        m_wakeUp.store( true, std::memory_order_relaxed );
+        signal();
+    }
+};
+
+
+#endif //PROMISE_MPSCEVENTQUEUE_H
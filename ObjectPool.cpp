@@ -8,4 +8,26 @@ void ObjectPoolDetail::PoolPointerDeleteFunctor::operator()(PooledObject *el)  {
     el->freeSelf();
 }
 
+void ObjectPoolDetail::freePooledObjects( PooledObject* const* objects, std::size_t num ) {
+    std::size_t begin= 0;
+    while( begin != num ) {
+        // Find the run of objects that belong to the same pool
+        auto pool= objects[begin]->m_pool;
+        std::size_t end= begin+ 1;
+        while( end != num && objects[end]->m_pool == pool ) {
+            end++;
+        }
+
+        if( pool ) {
+            pool->freeN( objects+ begin, end- begin );
+        } else {
+            for( auto i= begin; i!= end; i++ ) {
+                delete objects[i];
+            }
+        }
+
+        begin= end;
+    }
+}
+
 HeapAllocator heapAlloc;
\ No newline at end of file
@@ -7,9 +7,13 @@
 
 
 #include <mutex>
-#include <vector>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
 #include "SmallStack.h"
+#include "BlockSource.h"
 
 
 namespace AllocArrayDetail {
@@ -22,15 +26,102 @@ namespace AllocArrayDetail {
         void unlock() {}
         bool try_lock() { return true; }
     };
+}
+
+
+/**
+ * Pool Statistics Struct
+ * Snapshot of the counters of an allocation array
+ * The counters are only collected if PROMISE_POOL_STATISTICS is defined, otherwise
+ * they stay zero and only capacity and usage are filled in
+ */
+struct PoolStatistics {
+    std::size_t m_creates= 0;
+    std::size_t m_frees= 0;
+    std::size_t m_blockGrows= 0;
+    std::size_t m_blockReleases= 0;
+
+    std::size_t m_capacity= 0;
+    std::size_t m_usage= 0;
+    std::size_t m_peakUsage= 0;
+
+    // Only counted for synchronised arrays
+    std::size_t m_lockContentions= 0;
+    std::chrono::nanoseconds m_lockWaitTime{ 0 };
+
+    // Only counted for cached arrays
+    std::size_t m_cacheRefills= 0;
+    std::size_t m_cacheSpills= 0;
+};
 
-    template< int T_Size, int T_MaxSize >
-    class SizeChecker {
-        static_assert(T_Size <= T_MaxSize, "Element is too large for Object Pool cell.");
+
+namespace AllocArrayDetail {
+    /**
+     * Counters Class
+     * Collects the statistics of an allocation array while its lock is held
+     * If statistics are disabled all methods are empty and get optimized away
+     */
+    class Counters {
+#ifdef PROMISE_POOL_STATISTICS
+    private:
+        PoolStatistics m_stats;
+
+    public:
+        inline void onCreate( const std::size_t n= 1 ) { m_stats.m_creates+= n; }
+        inline void onFree( const std::size_t n= 1 ) { m_stats.m_frees+= n; }
+        inline void onBlockGrow() { m_stats.m_blockGrows++; }
+        inline void onBlockRelease( const std::size_t n ) { m_stats.m_blockReleases+= n; }
+
+        inline void onLockWait( const std::chrono::nanoseconds t ) {
+            m_stats.m_lockContentions++;
+            m_stats.m_lockWaitTime+= t;
+        }
+
+        inline PoolStatistics get() const { return m_stats; }
+#else
+    public:
+        inline void onCreate( const std::size_t= 1 ) {}
+        inline void onFree( const std::size_t= 1 ) {}
+        inline void onBlockGrow() {}
+        inline void onBlockRelease( const std::size_t ) {}
+        inline void onLockWait( const std::chrono::nanoseconds ) {}
+
+        inline PoolStatistics get() const { return PoolStatistics(); }
+#endif
     };
 
-    template< int T_Align, int T_MaxAlign >
-    class AlignChecker {
-        static_assert(T_Align <= T_MaxAlign, "Element alignment is not compatible with Object Pool cell.");
+    /**
+     * Templated Counting Lock Class
+     * Scoped lock, that measures the time spent waiting for the mutex if statistics
+     * are enabled. Uncontended locks are not timed at all
+     *
+     * @tparam T_Mutex - Type of mutex to lock
+     */
+    template< typename T_Mutex >
+    class CountingLock {
+    private:
+        T_Mutex& m_mutex;
+
+    public:
+        CountingLock( T_Mutex& m, Counters& c )
+                : m_mutex( m ) {
+#ifdef PROMISE_POOL_STATISTICS
+            if( !m_mutex.try_lock() ) {
+                auto start= std::chrono::steady_clock::now();
+                m_mutex.lock();
+                c.onLockWait( std::chrono::steady_clock::now()- start );
+            }
+#else
+            (void)c;
+            m_mutex.lock();
+#endif
+        }
+
+        CountingLock( const CountingLock& )= delete;
+
+        ~CountingLock() {
+            m_mutex.unlock();
+        }
     };
 }
 
@@ -44,7 +135,20 @@ class Deallocator {
 protected:
     virtual void deallocate( void* )= 0;
 
+    /**
+     * Return multiple cells at once
+     * Pools override this to only synchronise a single time per batch
+     */
+    virtual void deallocateCells( void* const* cells, const std::size_t num ) {
+        for( std::size_t i= 0; i!= num; i++ ) {
+            this->deallocate( cells[i] );
+        }
+    }
+
 public:
+    // Number of objects handled at once by batch operations that need a local buffer
+    static constexpr std::size_t T_batchChunkSize= 64;
+
     template< typename T_Element >
     void free( T_Element* ptr ) {
         // Destruct the object
@@ -52,6 +156,22 @@ public:
 
         this->deallocate( ptr );
     }
+
+    template< typename T_Element >
+    void freeN( T_Element* const* ptrs, const std::size_t num ) {
+        void* cells[ T_batchChunkSize ];
+
+        for( std::size_t i= 0; i!= num; ) {
+            // Destruct a chunk of objects and return their cells together
+            std::size_t n= 0;
+            for( ; n!= T_batchChunkSize && i!= num; n++, i++ ) {
+                ptrs[i]->~T_Element();
+                cells[n]= ptrs[i];
+            }
+
+            this->deallocateCells( cells, n );
+        }
+    }
 };
 
 
@@ -59,9 +179,19 @@ public:
 /**
  * Templated Allocation Array Class
  * Stores objects that satisfy the size and alignment specifications
- * Objects are created in blocks of cells. Pointers to the empty cells
- * are held by an array, that is accessed whenever a new object is
- * constructed or an old one is destructed
+ * Objects are created in blocks of cells. The empty cells of each block
+ * are chained up to an intrusive free list, where each empty cell stores
+ * the pointer to the next one inside of itself. Besides that every block
+ * only has a small record with its count of live cells
+ * The cells of a new block are handed out in order and only enter the
+ * free list once they are returned, so adding a block does not need to
+ * touch all of its cells
+ * Partially used blocks are filled up before empty ones. Blocks that are
+ * completely empty can be released again by trimming the array, either
+ * manually or automatically once the usage stays below a configurable
+ * watermark
+ * The memory of the blocks is provided by a block source, which allocates
+ * on the heap by default
  * Whether the creation and deletion of objects should happen
  * synchronized is determined by the T_Mutex template parameter
  *
@@ -73,67 +203,324 @@ template< std::size_t T_CellSize, std::size_t T_CellAlign, typename T_Mutex= All
 class AllocArray : public Deallocator {
 private:
 
-    using T_Cell= typename std::aligned_storage< T_CellSize, T_CellAlign >::type;
+    /**
+     * Internal Free Cell Struct
+     * Overlays an empty cell to link it into the free list
+     */
+    struct FreeCell {
+        FreeCell* m_next;
+    };
+
+    // Every cell has to be able to hold a free list link
+    static constexpr std::size_t T_StorageSize=  T_CellSize  > sizeof(FreeCell)  ? T_CellSize  : sizeof(FreeCell);
+    static constexpr std::size_t T_StorageAlign= T_CellAlign > alignof(FreeCell) ? T_CellAlign : alignof(FreeCell);
+
+    using T_Cell= typename std::aligned_storage< T_StorageSize, T_StorageAlign >::type;
+
+    /**
+     * Internal Block Struct
+     * Every block keeps its own free list and count of live cells, so blocks that
+     * run empty are known without looking at their cells. Blocks with empty cells
+     * are linked into the available list, where blocks without any objects are kept
+     * at the back. So partially used blocks are filled up first, and empty ones can
+     * be taken from the back when trimming
+     */
+    struct Block {
+        T_Cell* const m_cells;
+        FreeCell* m_freeList;
+
+        // Cells from this index on were never handed out
+        unsigned int m_unused;
+        unsigned int m_live;
+
+        Block* m_prev;
+        Block* m_next;
+
+        explicit Block( T_Cell* const c )
+                : m_cells( c ), m_freeList( nullptr ), m_unused( 0 ), m_live( 0 ), m_prev( nullptr ), m_next( nullptr ) {}
+    };
 
     T_Mutex m_mutex;
-    std::vector< T_Cell* > m_slots;
+    AllocArrayDetail::Counters m_counters;
 
-    SmallStack< std::unique_ptr< T_Cell[] > > m_blocks;
+    // Sorted by address to look up the block of a cell
+    std::vector< std::unique_ptr< Block > > m_blocks;
 
+    Block* m_availableFront;
+    Block* m_availableBack;
+    std::size_t m_emptyBlocks;
+
+    std::size_t m_freeCount;
+
+    // Usage statistics
+    std::size_t m_liveCount;
+    std::size_t m_peakCount;
+
+    // Automatic trimming
+    float m_trimWatermark;
+    std::size_t m_trimDelay;
+    std::size_t m_lowUsageCount;
+
+    BlockSource& m_source;
     const unsigned int m_blockSize;
 
+    inline std::size_t blockBytes() const {
+        return sizeof(T_Cell)* m_blockSize;
+    }
+
+    void linkFront( Block* const b ) {
+        b->m_prev= nullptr;
+        b->m_next= m_availableFront;
+        if( m_availableFront ) {
+            m_availableFront->m_prev= b;
+        } else {
+            m_availableBack= b;
+        }
+        m_availableFront= b;
+    }
+
+    void linkBack( Block* const b ) {
+        b->m_next= nullptr;
+        b->m_prev= m_availableBack;
+        if( m_availableBack ) {
+            m_availableBack->m_next= b;
+        } else {
+            m_availableFront= b;
+        }
+        m_availableBack= b;
+    }
+
+    void unlink( Block* const b ) {
+        (b->m_prev ? b->m_prev->m_next : m_availableFront)= b->m_next;
+        (b->m_next ? b->m_next->m_prev : m_availableBack)= b->m_prev;
+    }
+
+    /**
+     * Index of the block, that holds the cell or starts at the address
+     */
+    std::size_t findBlock( const void* const cell ) const {
+        auto it= std::upper_bound( m_blocks.begin(), m_blocks.end(), cell,
+                                   []( const void* const c, const std::unique_ptr< Block >& b ) {
+                                       return std::less<const void*>()( c, b->m_cells );
+                                   } );
+
+        return static_cast<std::size_t>( it- m_blocks.begin() )- 1;
+    }
+
     void addBlock() {
-        // Create new block of cells
-        auto block= std::make_unique<T_Cell[]>( m_blockSize );
+        // Create new block of cells without initializing them
+        auto cells= static_cast<T_Cell*>( m_source.allocateBlock( blockBytes(), alignof(T_Cell) ) );
+
+        std::unique_ptr< Block > block;
+        try {
+            block= std::make_unique< Block >( cells );
+
+            // Keep the blocks sorted by address
+            auto it= std::upper_bound( m_blocks.begin(), m_blocks.end(), cells,
+                                       []( const T_Cell* const c, const std::unique_ptr< Block >& b ) {
+                                           return std::less<const T_Cell*>()( c, b->m_cells );
+                                       } );
+            m_blocks.insert( it, std::move( block ) );
+
+        } catch( ... ) {
+            m_source.releaseBlock( cells, blockBytes(), alignof(T_Cell) );
+            throw;
+        }
 
-        // Add the empty cells as pointers to the array of slots
-        for( unsigned int i= 0; i!= m_blockSize; i++ ) {
-            m_slots.emplace_back( block.get()+ i );
+        // The cells of the new block are handed out in order once all other blocks are full
+        linkBack( m_blocks[ findBlock( cells ) ].get() );
+        m_emptyBlocks++;
+        m_freeCount+= m_blockSize;
+        m_counters.onBlockGrow();
+    }
+
+    std::size_t unsafeTrim() {
+        std::size_t numReleased= 0;
+
+        // Empty blocks are at the back of the available list, keep at least one block
+        while( m_emptyBlocks && m_blocks.size() > 1 ) {
+            auto b= m_availableBack;
+            unlink( b );
+            m_emptyBlocks--;
+
+            m_source.releaseBlock( b->m_cells, blockBytes(), alignof(T_Cell) );
+            m_blocks.erase( m_blocks.begin()+ findBlock( b->m_cells ) );
+            numReleased++;
+        }
+
+        if( numReleased ) {
+            m_freeCount-= numReleased* m_blockSize;
+            m_counters.onBlockRelease( numReleased );
+        }
+
+        return numReleased;
+    }
+
+    void checkAutoTrim() {
+        if( m_trimWatermark <= 0.0f ) {
+            return;
         }
 
-        // Add the block to the array of blocks
-        m_blocks.push( std::move(block) );
+        // Trim once the usage stayed below the watermark for long enough, but only
+        // count while there is an empty block that can be released
+        if( m_liveCount >= m_trimWatermark* capacity() || !m_emptyBlocks || m_blocks.size() < 2 ) {
+            m_lowUsageCount= 0;
+
+        } else if( ++m_lowUsageCount >= m_trimDelay ) {
+            m_lowUsageCount= 0;
+            unsafeTrim();
+        }
+    }
+
+    T_Cell* unsafeAcquire() {
+        // Add new block, if no cells are left
+        if( !m_availableFront ) {
+            addBlock();
+        }
+
+        // Prefer recently returned cells of the block
+        auto b= m_availableFront;
+        T_Cell* cell;
+        if( b->m_freeList ) {
+            cell= reinterpret_cast<T_Cell*>( b->m_freeList );
+            b->m_freeList= b->m_freeList->m_next;
+
+        } else {
+            cell= b->m_cells+ b->m_unused++;
+        }
+
+        if( !b->m_live++ ) {
+            m_emptyBlocks--;
+        }
+
+        if( b->m_live == m_blockSize ) {
+            unlink( b );
+        }
+
+        m_freeCount--;
+
+        if( ++m_liveCount > m_peakCount ) {
+            m_peakCount= m_liveCount;
+        }
+
+        m_counters.onCreate();
+
+        return cell;
+    }
+
+    void unsafeRelease( void* ptr ) {
+        auto b= m_blocks[ findBlock( ptr ) ].get();
+
+        // A full block has empty cells again
+        if( b->m_live == m_blockSize ) {
+            linkFront( b );
+        }
+
+        // Link the cell into the free list of its block
+        b->m_freeList= new(ptr) FreeCell{ b->m_freeList };
+
+        // Move blocks that run empty to the back, so they are only used once all others are full
+        if( !--b->m_live ) {
+            m_emptyBlocks++;
+            unlink( b );
+            linkBack( b );
+        }
+
+        m_freeCount++;
+        m_liveCount--;
+        m_counters.onFree();
     }
 
 protected:
     void deallocate( void* ptr ) override {
         // Return the cell
-        std::lock_guard<T_Mutex> lock(m_mutex);
-        m_slots.emplace_back( reinterpret_cast<T_Cell*>(ptr ) );
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+        unsafeRelease( ptr );
+        checkAutoTrim();
+    }
+
+    /**
+     * Return multiple cells at once while holding the lock only a single time
+     */
+    void deallocateCells( void* const* cells, const std::size_t num ) override {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+
+        for( std::size_t i= 0; i!= num; i++ ) {
+            unsafeRelease( cells[i] );
+        }
+
+        checkAutoTrim();
     }
 
 public:
-    explicit AllocArray( const unsigned int s )
-            : m_blockSize( s ) {
-        m_slots.reserve( m_blockSize );
+    explicit AllocArray( const unsigned int s, BlockSource& src= BlockSource::heap() )
+            : m_availableFront( nullptr ), m_availableBack( nullptr ), m_emptyBlocks( 0 ),
+              m_freeCount( 0 ), m_liveCount( 0 ), m_peakCount( 0 ),
+              m_trimWatermark( 0.0f ), m_trimDelay( 0 ), m_lowUsageCount( 0 ),
+              m_source( src ), m_blockSize( s ) {
         addBlock();
     }
 
     AllocArray( const AllocArray& )= delete;
 
+    ~AllocArray() {
+        for( auto& block : m_blocks ) {
+            m_source.releaseBlock( block->m_cells, blockBytes(), alignof(T_Cell) );
+        }
+    }
+
     template< typename T_Element, typename ... T_Args >
     T_Element* create( T_Args&& ... args ) {
         // Assert size and alignment
-        AllocArrayDetail::SizeChecker<  sizeof(T_Element),  T_CellSize  > checkSize;
-        AllocArrayDetail::AlignChecker< alignof(T_Element), T_CellAlign > checkAlign;
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
 
         T_Cell* cell;
         {
-            // Lock the array
-            std::lock_guard<T_Mutex> lock(m_mutex);
+            // Lock the array and fetch empty cell
+            AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+            cell= unsafeAcquire();
+        }
 
-            // Add new block, if no cells are left
-            if (m_slots.empty()) {
-                addBlock();
+        // Construct new object in the empty cell
+        return new(cell) T_Element( std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create a pooled object, that gets this array passed as its deallocator
+     */
+    template< typename T_Element, typename ... T_Args >
+    T_Element* createPooled( T_Args&& ... args ) {
+        return create<T_Element>( static_cast<Deallocator*>( this ), std::forward<T_Args>(args)... );
+    }
+
+    /**
+     * Create multiple objects at once while holding the lock only a single time
+     * Every object is constructed from copies of the same arguments
+     */
+    template< typename T_Element, typename ... T_Args >
+    void createN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        {
+            // Lock the array and fetch all empty cells
+            AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+            for( std::size_t i= 0; i!= num; i++ ) {
+                objects[i]= reinterpret_cast<T_Element*>( unsafeAcquire() );
             }
+        }
 
-            // Fetch empty cell
-            cell = m_slots.back();
-            m_slots.pop_back();
+        // Construct the new objects in the empty cells
+        for( std::size_t i= 0; i!= num; i++ ) {
+            objects[i]= new(objects[i]) T_Element( args... );
         }
+    }
 
-        // Construct new object in the empty cell
-        return new(cell) T_Element( std::forward<T_Args>(args)... );
+    template< typename T_Element, typename ... T_Args >
+    void createPooledN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        createN<T_Element>( objects, num, static_cast<Deallocator*>( this ), args... );
     }
 
     template< typename T_Element >
@@ -148,8 +535,117 @@ public:
         deallocate( ptr );
     }
 
+    /**
+     * Destruct multiple objects and return them while holding the lock only a single time
+     */
+    template< typename T_Element >
+    void freeN( T_Element* const* ptrs, const std::size_t num ) {
+        // Assert size and alignment
+        static_assert(sizeof(T_Element) <= T_CellSize, "Element is too large for Object Pool cell.");
+        static_assert(alignof(T_Element) <= T_CellAlign, "Element alignment is not compatible with Object Pool cell.");
+
+        Deallocator::freeN( ptrs, num );
+    }
+
+    /**
+     * Fetch a single uninitialized cell
+     * Used by allocators, that construct the objects themselves
+     */
+    void* allocateCell() {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+        return unsafeAcquire();
+    }
+
+    /**
+     * Return a cell fetched by 'allocateCell' without running any destructor
+     */
+    void freeCell( void* ptr ) {
+        deallocate( ptr );
+    }
+
+    /**
+     * Fetch multiple empty cells at once while holding the lock only a single time
+     * Used by caching layers to move cells in batches
+     */
+    void allocateCells( void** cells, const std::size_t num ) {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+
+        for( std::size_t i= 0; i!= num; i++ ) {
+            cells[i]= unsafeAcquire();
+        }
+    }
+
+    /**
+     * Return multiple cells fetched by 'allocateCells' without running any destructor
+     */
+    void freeCells( void* const* cells, const std::size_t num ) {
+        deallocateCells( cells, num );
+    }
+
     std::size_t space() const {
-        return m_slots.size();
+        return m_freeCount;
+    }
+
+    /**
+     * Release all blocks that do not hold any objects, but keep at least one
+     * @return Number of blocks released
+     */
+    std::size_t trim() {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+        return unsafeTrim();
+    }
+
+    /**
+     * Enable automatic trimming
+     * The array is trimmed once the usage stayed below the watermark for a number
+     * of consecutive deallocations. A watermark of zero disables automatic trimming
+     *
+     * @param watermark - Fraction of the capacity
+     * @param delay - Number of deallocations the usage has to stay below the watermark
+     */
+    void setAutoTrim( const float watermark, const std::size_t delay ) {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+        m_trimWatermark= watermark;
+        m_trimDelay= delay;
+        m_lowUsageCount= 0;
+    }
+
+    std::size_t capacity() const {
+        return m_blocks.size()* m_blockSize;
+    }
+
+    /**
+     * Add blocks until the array can hold at least the provided number of objects
+     * Combined with a prefaulting block source this moves the cost of first touching
+     * the memory to the time of the call
+     */
+    void reserve( const std::size_t num ) {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+
+        while( capacity() < num ) {
+            addBlock();
+        }
+    }
+
+    std::size_t usage() const {
+        return m_liveCount;
+    }
+
+    std::size_t peakUsage() const {
+        return m_peakCount;
+    }
+
+    /**
+     * Take a snapshot of the statistics
+     */
+    PoolStatistics statistics() {
+        AllocArrayDetail::CountingLock<T_Mutex> lock( m_mutex, m_counters );
+
+        auto stats= m_counters.get();
+        stats.m_capacity= capacity();
+        stats.m_usage= m_liveCount;
+        stats.m_peakUsage= m_peakCount;
+        return stats;
     }
 };
 
@@ -203,9 +699,9 @@ template<typename ... T_Elements>
 class ObjectPool : public AllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
                                       ObjectPoolDetail::requiredAlign<T_Elements...>::value > {
 public:
-    explicit ObjectPool(const unsigned int s)
+    explicit ObjectPool(const unsigned int s, BlockSource& src= BlockSource::heap())
             : AllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
-                          ObjectPoolDetail::requiredAlign<T_Elements...>::value >( s ) {}
+                          ObjectPoolDetail::requiredAlign<T_Elements...>::value >( s, src ) {}
 
 };
 
@@ -223,10 +719,10 @@ class SyncObjectPool : public AllocArray< ObjectPoolDetail::requiredSize<T_Eleme
                                           ObjectPoolDetail::requiredAlign<T_Elements...>::value,
                                           std::mutex > {
 public:
-    explicit SyncObjectPool(const unsigned int s)
+    explicit SyncObjectPool(const unsigned int s, BlockSource& src= BlockSource::heap())
             : AllocArray< ObjectPoolDetail::requiredSize<T_Elements...>::value,
             ObjectPoolDetail::requiredAlign<T_Elements...>::value,
-            std::mutex                                                          >( s ) {}
+            std::mutex                                                          >( s, src ) {}
 
 };
 
@@ -244,6 +740,12 @@ namespace ObjectPoolDetail {
     public:
         void operator()( PooledObject* el );
     };
+
+    /**
+     * Free multiple pooled objects
+     * Consecutive objects of the same pool are returned together
+     */
+    void freePooledObjects( PooledObject* const* objects, std::size_t num );
 }
 
 class PooledObject {
@@ -258,6 +760,7 @@ public:
 
 protected:
     friend class ObjectPoolDetail::PoolPointerDeleteFunctor;
+    friend void ObjectPoolDetail::freePooledObjects( PooledObject* const*, std::size_t );
 
     void freeSelf() {
         if( m_pool ) {
@@ -287,8 +790,46 @@ public:
 
     template< typename T_Element, typename ... T_Params >
     PoolPointer< T_Element > allocate( T_Params&& ... args ) {
-        return PoolPointer<T_Element>( m_pool.template create<T_Element>( &m_pool, std::forward<T_Params>(args)... ) );
+        return PoolPointer<T_Element>( m_pool.template createPooled<T_Element>( std::forward<T_Params>(args)... ) );
     }
+
+    /**
+     * Allocate multiple objects with a single synchronisation per chunk
+     * Every object is constructed from copies of the same arguments
+     */
+    template< typename T_Element, typename ... T_Params >
+    void allocateN( PoolPointer< T_Element >* ptrs, const std::size_t num, const T_Params& ... args ) {
+        T_Element* objects[ Deallocator::T_batchChunkSize ];
+
+        for( std::size_t i= 0; i< num; i+= Deallocator::T_batchChunkSize ) {
+            auto n= std::min( num- i, Deallocator::T_batchChunkSize );
+            m_pool.template createPooledN<T_Element>( objects, n, args... );
+
+            for( std::size_t j= 0; j!= n; j++ ) {
+                ptrs[i+ j].reset( objects[j] );
+            }
+        }
+    }
+
+    /**
+     * Free multiple objects with a single synchronisation per chunk
+     */
+    template< typename T_Element >
+    void freeN( PoolPointer< T_Element >* ptrs, const std::size_t num ) {
+        PooledObject* objects[ Deallocator::T_batchChunkSize ];
+
+        for( std::size_t i= 0; i< num; i+= Deallocator::T_batchChunkSize ) {
+            auto n= std::min( num- i, Deallocator::T_batchChunkSize );
+
+            for( std::size_t j= 0; j!= n; j++ ) {
+                objects[j]= ptrs[i+ j].release();
+            }
+
+            ObjectPoolDetail::freePooledObjects( objects, n );
+        }
+    }
+
+    inline T_Pool& getPool() { return m_pool; }
 };
 
 
@@ -304,6 +845,20 @@ public:
     PoolPointer< T_Element > allocate( T_Params&& ... args ) {
         return PoolPointer<T_Element>( new T_Element( nullptr, std::forward<T_Params>(args)... ) );
     }
+
+    template< typename T_Element, typename ... T_Params >
+    void allocateN( PoolPointer< T_Element >* ptrs, const std::size_t num, const T_Params& ... args ) {
+        for( std::size_t i= 0; i!= num; i++ ) {
+            ptrs[i].reset( new T_Element( nullptr, args... ) );
+        }
+    }
+
+    template< typename T_Element >
+    void freeN( PoolPointer< T_Element >* ptrs, const std::size_t num ) {
+        for( std::size_t i= 0; i!= num; i++ ) {
+            ptrs[i].reset();
+        }
+    }
 };
 
 extern HeapAllocator heapAlloc;
@@ -5,13 +5,22 @@
 #ifndef PROMISE_POOLDEFS_H
 #define PROMISE_POOLDEFS_H
 
-#include "ObjectPool.h"
+#include "CachedObjectPool.h"
+#include "SizeClassPool.h"
 
 /**
  * Workaround as nested types cannot be forward declared
  */
 namespace PoolDefs {
-    using T_EventPool= SyncObjectPool< std::aligned_storage<96, sizeof(void*)>::type >;
+    template< std::size_t T_Size >
+    using T_EventClassArray= CachedAllocArray< T_Size, SizeClassPoolDetail::T_classAlign >;
+
+    using T_EventPool= SizeClassPool< T_EventClassArray >;
+
+    template< std::size_t T_Size >
+    using T_ContainerClassArray= AllocArray< T_Size, SizeClassPoolDetail::T_classAlign, std::mutex >;
+
+    using T_ContainerPool= SizeClassPool< T_ContainerClassArray >;
 }
 
 
@@ -0,0 +1,11 @@
+//
+// Created by Matthias Preymann on 22.09.2019.
+//
+
+#include "PoolStdAllocator.h"
+
+PoolDefs::T_ContainerPool& PoolStdAllocatorDetail::defaultPool() {
+    // Containers are usually small, so the blocks do not have to be large either
+    static PoolDefs::T_ContainerPool* pool= new PoolDefs::T_ContainerPool( 32 );
+    return *pool;
+}
@@ -0,0 +1,102 @@
+//
+// Created by Matthias Preymann on 22.09.2019.
+//
+
+#ifndef PROMISE_POOLSTDALLOCATOR_H
+#define PROMISE_POOLSTDALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include "PoolDefs.h"
+
+
+namespace PoolStdAllocatorDetail {
+    /**
+     * Synchronised pool shared by all default constructed allocators
+     * It is never destroyed, as containers with static storage duration might outlive it otherwise
+     */
+    PoolDefs::T_ContainerPool& defaultPool();
+}
+
+
+/**
+ * Templated Pool Std Allocator Class
+ * Allocator for standard containers, that takes its memory from a size class pool
+ * Allocations of single nodes and of small arrays are served by the class their
+ * size fits into. Larger arrays and over-aligned types fall back to the heap
+ * Allocators compare equal if they use the same pool
+ *
+ * @tparam T      - Type of object to allocate
+ * @tparam T_Pool - Type of size class pool, has to be synchronised if the container is shared by threads
+ */
+template< typename T, typename T_Pool= PoolDefs::T_ContainerPool >
+class PoolStdAllocator {
+private:
+    template< typename, typename >
+    friend class PoolStdAllocator;
+
+    T_Pool* m_pool;
+
+    static constexpr bool T_overAligned= alignof(T) > SizeClassPoolDetail::T_classAlign;
+
+public:
+    using value_type= T;
+
+    using propagate_on_container_copy_assignment= std::true_type;
+    using propagate_on_container_move_assignment= std::true_type;
+    using propagate_on_container_swap= std::true_type;
+    using is_always_equal= std::false_type;
+
+    /**
+     * Use the default pool, only available for the default pool type
+     */
+    PoolStdAllocator() noexcept
+            : m_pool( &PoolStdAllocatorDetail::defaultPool() ) {}
+
+    explicit PoolStdAllocator( T_Pool& p ) noexcept
+            : m_pool( &p ) {}
+
+    template< typename U >
+    PoolStdAllocator( const PoolStdAllocator< U, T_Pool >& other ) noexcept
+            : m_pool( other.m_pool ) {}
+
+    T* allocate( const std::size_t n ) {
+        if( n > static_cast<std::size_t>(-1) / sizeof(T) ) {
+            throw std::bad_array_new_length();
+        }
+
+        if constexpr ( T_overAligned ) {
+            return static_cast<T*>( ::operator new( n* sizeof(T), std::align_val_t( alignof(T) ) ) );
+
+        } else {
+            return static_cast<T*>( m_pool->allocateBytes( n* sizeof(T) ) );
+        }
+    }
+
+    void deallocate( T* ptr, const std::size_t n ) {
+        if constexpr ( T_overAligned ) {
+            ::operator delete( ptr, std::align_val_t( alignof(T) ) );
+
+        } else {
+            m_pool->freeBytes( ptr, n* sizeof(T) );
+        }
+    }
+
+    inline T_Pool& getPool() const {
+        return *m_pool;
+    }
+
+    template< typename U >
+    bool operator==( const PoolStdAllocator< U, T_Pool >& other ) const {
+        return m_pool == other.m_pool;
+    }
+
+    template< typename U >
+    bool operator!=( const PoolStdAllocator< U, T_Pool >& other ) const {
+        return m_pool != other.m_pool;
+    }
+};
+
+
+#endif //PROMISE_POOLSTDALLOCATOR_H
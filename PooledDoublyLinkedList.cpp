@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 30.09.2019.
+//
+
+#include "PooledDoublyLinkedList.h"
\ No newline at end of file
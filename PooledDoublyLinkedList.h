@@ -0,0 +1,349 @@
+//
+// Created by Matthias Preymann on 30.09.2019.
+//
+
+#ifndef PROMISE_POOLEDDOUBLYLINKEDLIST_H
+#define PROMISE_POOLEDDOUBLYLINKEDLIST_H
+
+#include <memory>
+#include <stdexcept>
+#include "ObjectPool.h"
+
+/**
+ * Templated Pooled Doubly Linked List Class
+ * Doubly linked list, that allocates its entries in a pool of variable size
+ * The links are stored inside the entries next to the data, so every entry
+ * can be unlinked or moved in O(1) through its handle. Handles stay valid
+ * until their entry is erased, no matter where the entry is moved
+ * Entries can only be spliced between lists that share the same pool, which
+ * is either owned by the list or provided by the user
+ *
+ * @tparam T_DataType - Type to store
+ */
+template< typename T_DataType >
+class PooledDoublyLinkedList {
+private:
+
+    /**
+     * Internal Links Struct
+     * The list itself holds a links object as sentinel, so no entry
+     * ever has a null neighbour
+     */
+    struct Links {
+        Links* m_prev;
+        Links* m_next;
+    };
+
+    /**
+     * Internal List Entry Class
+     * Stores the links and the data publicly
+     */
+    class ListEntry : public Links {
+    public:
+        T_DataType m_data;
+
+        template< typename ... T_Args >
+        explicit ListEntry( T_Args&& ... args )
+        : Links{ nullptr, nullptr }, m_data( std::forward<T_Args>( args )... ) {}
+    };
+
+public:
+    using Pool= ObjectPool< ListEntry >;
+
+private:
+    std::unique_ptr< Pool > m_ownPool;
+    Pool& m_pool;
+
+    Links m_sentinel;
+    std::size_t m_size;
+
+    static inline void unlinkEntry( Links* const e ) {
+        e->m_prev->m_next= e->m_next;
+        e->m_next->m_prev= e->m_prev;
+    }
+
+    static inline void linkBefore( Links* const pos, Links* const e ) {
+        e->m_prev= pos->m_prev;
+        e->m_next= pos;
+        pos->m_prev->m_next= e;
+        pos->m_prev= e;
+    }
+
+    inline ListEntry* getEntry( Links* const l ) {
+        if( l == &m_sentinel ) {
+            throw std::runtime_error("Cannot access element of empty list.");
+        }
+        return static_cast<ListEntry*>( l );
+    }
+
+    void checkPool( const PooledDoublyLinkedList& other ) const {
+        if( &m_pool != &other.m_pool ) {
+            throw std::runtime_error("Cannot splice entries between lists with different pools.");
+        }
+    }
+
+public:
+    /**
+     * Handle Class
+     * Stable reference to a single entry
+     * A null handle refers to the position behind the last entry
+     */
+    class Handle {
+    private:
+        friend PooledDoublyLinkedList;
+
+        ListEntry* m_entry;
+
+    public:
+        explicit Handle( ListEntry* const e )
+        : m_entry( e ) {}
+
+        Handle()
+        : m_entry( nullptr ) {}
+
+        explicit inline operator bool() const {
+            return static_cast<bool>( m_entry );
+        }
+
+        inline bool operator==( const Handle& h ) const {
+            return m_entry == h.m_entry;
+        }
+
+        inline bool operator!=( const Handle& h ) const {
+            return m_entry != h.m_entry;
+        }
+
+        inline T_DataType& get() const {
+            return m_entry->m_data;
+        }
+
+        inline T_DataType& operator*() const {
+            return get();
+        }
+
+        inline T_DataType* operator->() const {
+            return &get();
+        }
+    };
+
+    /**
+     * Iterator Class
+     * Provides an interface to iterate over the list in both directions
+     */
+    class Iterator {
+    private:
+        friend PooledDoublyLinkedList;
+
+        Links* m_position;
+        const Links* m_end;
+
+        Iterator( Links* const p, const Links* const e )
+        : m_position( p ), m_end( e ) {}
+
+    public:
+        inline void next() {
+            m_position= m_position->m_next;
+        }
+
+        inline void prev() {
+            m_position= m_position->m_prev;
+        }
+
+        inline void operator++(int) {
+            next();
+        }
+
+        inline void operator--(int) {
+            prev();
+        }
+
+        inline bool isEnd() const {
+            return m_position == m_end;
+        }
+
+        explicit inline operator bool() const {
+            return !isEnd();
+        }
+
+        inline T_DataType& get() {
+            return static_cast<ListEntry*>( m_position )->m_data;
+        }
+
+        inline T_DataType& operator*() {
+            return get();
+        }
+
+        inline Handle handle() const {
+            return isEnd() ? Handle() : Handle( static_cast<ListEntry*>( m_position ) );
+        }
+    };
+
+
+    static constexpr size_t T_defaultBucketSize= 32;
+
+    explicit PooledDoublyLinkedList( const size_t s= T_defaultBucketSize )
+    : m_ownPool( std::make_unique< Pool >( s ) ), m_pool( *m_ownPool ), m_sentinel{ &m_sentinel, &m_sentinel }, m_size( 0 ) {}
+
+    /**
+     * Use a pool shared with other lists, which has to outlive the list
+     */
+    explicit PooledDoublyLinkedList( Pool& p )
+    : m_pool( p ), m_sentinel{ &m_sentinel, &m_sentinel }, m_size( 0 ) {}
+
+    PooledDoublyLinkedList( const PooledDoublyLinkedList& )= delete;
+
+    ~PooledDoublyLinkedList() {
+        clear();
+    }
+
+    inline bool isEmpty() const {
+        return !m_size;
+    }
+
+    inline std::size_t getLength() const {
+        return m_size;
+    }
+
+    inline Iterator begin() {
+        return Iterator( m_sentinel.m_next, &m_sentinel );
+    }
+
+    inline Iterator rbegin() {
+        return Iterator( m_sentinel.m_prev, &m_sentinel );
+    }
+
+    /**
+     * Get an iterator that starts at the entry of the handle
+     */
+    inline Iterator iteratorOf( const Handle h ) {
+        return h ? Iterator( h.m_entry, &m_sentinel ) : Iterator( &m_sentinel, &m_sentinel );
+    }
+
+    inline T_DataType& front() {
+        return getEntry( m_sentinel.m_next )->m_data;
+    }
+
+    inline T_DataType& back() {
+        return getEntry( m_sentinel.m_prev )->m_data;
+    }
+
+    inline Handle frontHandle() {
+        return isEmpty() ? Handle() : Handle( getEntry( m_sentinel.m_next ) );
+    }
+
+    inline Handle backHandle() {
+        return isEmpty() ? Handle() : Handle( getEntry( m_sentinel.m_prev ) );
+    }
+
+    /**
+     * Create a new entry in front of the position
+     * A null handle inserts at the back
+     */
+    template< typename ... T_Args >
+    Handle insertBefore( const Handle pos, T_Args&& ... args ) {
+        auto elem= m_pool.template create<ListEntry>( std::forward<T_Args>( args )... );
+        linkBefore( pos ? static_cast<Links*>( pos.m_entry ) : &m_sentinel, elem );
+        m_size++;
+
+        return Handle( elem );
+    }
+
+    template< typename ... T_Args >
+    Handle insertAfter( const Handle pos, T_Args&& ... args ) {
+        auto next= pos ? pos.m_entry->m_next : m_sentinel.m_next;
+        return insertBefore( next == &m_sentinel ? Handle() : Handle( static_cast<ListEntry*>( next ) ),
+                             std::forward<T_Args>( args )... );
+    }
+
+    template< typename ... T_Args >
+    inline Handle pushFront( T_Args&& ... args ) {
+        return insertBefore( frontHandle(), std::forward<T_Args>( args )... );
+    }
+
+    template< typename ... T_Args >
+    inline Handle pushBack( T_Args&& ... args ) {
+        return insertBefore( Handle(), std::forward<T_Args>( args )... );
+    }
+
+    /**
+     * Unlink the entry and put it back into the pool, which invalidates its handle
+     */
+    void erase( const Handle h ) {
+        unlinkEntry( h.m_entry );
+        m_size--;
+        m_pool.free( h.m_entry );
+    }
+
+    void popFront() {
+        erase( Handle( getEntry( m_sentinel.m_next ) ) );
+    }
+
+    void popBack() {
+        erase( Handle( getEntry( m_sentinel.m_prev ) ) );
+    }
+
+    /**
+     * Move the entry of another list (or this one) in front of the position
+     * A null position moves the entry to the back
+     */
+    void splice( const Handle pos, PooledDoublyLinkedList& other, const Handle h ) {
+        checkPool( other );
+
+        if( pos == h ) {
+            return;
+        }
+
+        unlinkEntry( h.m_entry );
+        other.m_size--;
+
+        linkBefore( pos ? static_cast<Links*>( pos.m_entry ) : &m_sentinel, h.m_entry );
+        m_size++;
+    }
+
+    /**
+     * Move all entries of another list in front of the position
+     */
+    void splice( const Handle pos, PooledDoublyLinkedList& other ) {
+        checkPool( other );
+
+        if( &other == this || other.isEmpty() ) {
+            return;
+        }
+
+        auto first= other.m_sentinel.m_next;
+        auto last= other.m_sentinel.m_prev;
+        other.m_sentinel.m_next= other.m_sentinel.m_prev= &other.m_sentinel;
+
+        Links* next= pos ? static_cast<Links*>( pos.m_entry ) : &m_sentinel;
+        first->m_prev= next->m_prev;
+        last->m_next= next;
+        next->m_prev->m_next= first;
+        next->m_prev= last;
+
+        m_size+= other.m_size;
+        other.m_size= 0;
+    }
+
+    inline void moveToFront( const Handle h ) {
+        splice( frontHandle(), *this, h );
+    }
+
+    inline void moveToBack( const Handle h ) {
+        splice( Handle(), *this, h );
+    }
+
+    void clear() {
+        auto l= m_sentinel.m_next;
+        while( l != &m_sentinel ) {
+            auto next= l->m_next;
+            m_pool.free( static_cast<ListEntry*>( l ) );
+            l= next;
+        }
+
+        m_sentinel.m_next= m_sentinel.m_prev= &m_sentinel;
+        m_size= 0;
+    }
+};
+
+
+#endif //PROMISE_POOLEDDOUBLYLINKEDLIST_H
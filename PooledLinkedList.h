@@ -93,9 +93,13 @@ public:
     : m_pool( s ), m_begin(nullptr) {}
 
     ~PooledLinkedList() {
-        // Destruct all entries
-        for( auto it= begin(); it; it++ ) {
-            m_pool.free( it.m_position );
+        // Destruct all entries, the next pointer has to be read before
+        // the entry is returned to the pool
+        auto e= m_begin;
+        while( e ) {
+            auto next= e->m_next;
+            m_pool.free( e );
+            e= next;
         }
     }
 
@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 08.10.2019.
+//
+
+#include "Priority.h"
@@ -0,0 +1,92 @@
+//
+// Created by Matthias Preymann on 08.10.2019.
+//
+
+#ifndef PROMISE_PRIORITY_H
+#define PROMISE_PRIORITY_H
+
+
+/**
+ * Priority classes of tasks and events, each one is queued in its own lane
+ * Critical: Latency sensitive work like answering a request
+ * Normal:   Default for all work
+ * Bulk:     Long running batch jobs, that may be delayed
+ */
+enum class Priority : unsigned int {
+    Critical,
+    Normal,
+    Bulk
+};
+
+static constexpr unsigned int T_priorityCount= 3;
+
+inline constexpr unsigned int laneOf( const Priority p ) {
+    return static_cast<unsigned int>( p );
+}
+
+
+/**
+ * Templated Lane Scheduler Class
+ * Decides which lane of a queue to serve next. Lanes with a lower index are
+ * preferred, but a lane that is passed over while it holds elements ages. Once
+ * it was passed over T_maxSkips times in a row it is served next, so higher
+ * lanes can delay lower ones but never starve them
+ * The scheduler is not synchronised
+ *
+ * @tparam T_laneCount - Number of lanes to choose from
+ */
+template< unsigned int T_laneCount >
+class LaneScheduler {
+private:
+    unsigned int m_skips[ T_laneCount ];
+
+public:
+    static constexpr unsigned int T_maxSkips= 8;
+
+    LaneScheduler()
+            : m_skips{} {}
+
+    /**
+     * Pick the next lane to serve
+     * @param isEmpty - Functor that tells whether a lane is empty
+     * @return Index of the lane, T_laneCount if all lanes are empty
+     */
+    template< typename T_Func >
+    unsigned int next( T_Func&& isEmpty ) {
+        if constexpr ( T_laneCount == 1 ) {
+            return isEmpty( 0 ) ? 1 : 0;
+
+        } else {
+            unsigned int lane= T_laneCount;
+            bool empty[ T_laneCount ];
+
+            for( unsigned int i= 0; i!= T_laneCount; i++ ) {
+                empty[i]= isEmpty( i );
+                if( empty[i] ) {
+                    m_skips[i]= 0;
+                    continue;
+                }
+
+                // Take the first lane that has elements, unless a later one is starving
+                if( lane == T_laneCount || m_skips[i] >= T_maxSkips ) {
+                    lane= i;
+                }
+            }
+
+            for( unsigned int i= 0; i!= T_laneCount; i++ ) {
+                if( !empty[i] && i != lane ) {
+                    m_skips[i]++;
+                }
+            }
+
+            if( lane != T_laneCount ) {
+                m_skips[ lane ]= 0;
+            }
+
+            return lane;
+        }
+    }
+};
+
+
+#endif //PROMISE_PRIORITY_H
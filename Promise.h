@@ -7,6 +7,7 @@
 
 #include "Task.h"
 #include "WorkerPool.h"
+#include "EventLoop.h"
 
 /**
  * Templated Promise Class
@@ -57,12 +58,23 @@ public:
         }
         m_callbackReject= std::move( r );
     }
+
+    /**
+     * Send the reject event without any data set, promises with data in their
+     * reject event should fill it in
+     */
+    void reject( EventLoop& l ) override {
+        if( m_callbackReject ) {
+            l.sendEvent( std::move( m_callbackReject ) );
+        }
+    }
 };
 
 /**
  * Templated Promise Builder Class
  * Serves the setup of a promise with its resolve and reject event
  * Automatically adds the promise as a task to the Worker Pool on its destruction
+ * If the Worker Pool does not accept the task, its reject event is sent instead
  *
  * @tparam T_Promise - Type of promise to point to
  */
@@ -72,6 +84,7 @@ private:
     PoolPointer<T_Promise> m_promise;
     WorkerPool& m_pool;
     T_Allocator& m_alloc;
+    Priority m_priority;
 
 public:
 
@@ -84,10 +97,13 @@ public:
 
     // Constructors & Destructors
     PromiseBuilder( PoolPointer<T_Promise> pr, WorkerPool& p, T_Allocator& a )
-            : m_promise( std::move(pr) ), m_pool(p), m_alloc(a) {}
+            : m_promise( std::move(pr) ), m_pool(p), m_alloc(a), m_priority( Priority::Normal ) {}
 
     ~PromiseBuilder() {
-        m_pool.submitTask( std::move(m_promise) );
+        // A moved from builder has nothing to submit
+        if( m_promise ) {
+            m_pool.submitTask( std::move(m_promise), m_priority );
+        }
     }
 
 
@@ -96,6 +112,14 @@ public:
 
 
     // Chainable setters
+    /**
+     * Set the lane the task is queued in, and that its events are sent with
+     */
+    inline PromiseBuilder& priority( const Priority p ) {
+        m_priority= p;
+        return *this;
+    }
+
     inline PromiseBuilder& then( PoolPointer<typename T_Promise::T_ResolveEventBase> res ) {
         m_promise->setResolve( std::move(res) );
         return *this;
@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 18.09.2019.
+//
+
+#include "SizeClassPool.h"
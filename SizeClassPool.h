@@ -0,0 +1,203 @@
+//
+// Created by Matthias Preymann on 18.09.2019.
+//
+
+#ifndef PROMISE_SIZECLASSPOOL_H
+#define PROMISE_SIZECLASSPOOL_H
+
+#include <cstddef>
+#include <utility>
+#include "ObjectPool.h"
+
+
+namespace SizeClassPoolDetail {
+    /**
+     * Cell sizes of the classes in ascending order
+     */
+    static constexpr std::size_t T_classSizes[]= { 32, 64, 128, 256, 512 };
+    static constexpr std::size_t T_classCount= sizeof(T_classSizes) / sizeof(T_classSizes[0]);
+    static constexpr std::size_t T_classAlign= alignof(std::max_align_t);
+
+    /**
+     * Find the smallest class an object fits into
+     * @return Index of the class or -1 if it is too large
+     */
+    constexpr int findClass( const std::size_t size, const std::size_t align ) {
+        if( align > T_classAlign ) {
+            return -1;
+        }
+
+        for( std::size_t i= 0; i!= T_classCount; i++ ) {
+            if( size <= T_classSizes[i] ) {
+                return static_cast<int>( i );
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * Templated Class Entry Struct
+     * Holds the allocation array of a single class
+     */
+    template< template<std::size_t> class T_Array, std::size_t T_Index >
+    struct ClassEntry {
+        T_Array< T_classSizes[T_Index] > m_array;
+
+        ClassEntry( const unsigned int s, BlockSource& src )
+                : m_array( s, src ) {}
+    };
+
+    /**
+     * Templated Class Set Struct
+     * Holds the arrays of all classes, which are all constructed with the
+     * same arguments (the arrays are neither copyable nor movable)
+     */
+    template< template<std::size_t> class T_Array, typename T_Indices >
+    struct ClassSet;
+
+    template< template<std::size_t> class T_Array, std::size_t ... T_Indices >
+    struct ClassSet< T_Array, std::index_sequence< T_Indices... > > : ClassEntry< T_Array, T_Indices >... {
+        ClassSet( const unsigned int s, BlockSource& src )
+                : ClassEntry< T_Array, T_Indices >( s, src )... {}
+
+        template< std::size_t T_Index >
+        inline auto& get() {
+            return static_cast< ClassEntry< T_Array, T_Index >& >( *this ).m_array;
+        }
+
+        template< typename T_Func >
+        void forEach( T_Func&& func ) {
+            (func( get<T_Indices>() ), ...);
+        }
+
+        template< typename T_Func >
+        auto sum( T_Func&& func ) {
+            return (func( get<T_Indices>() )+ ...);
+        }
+
+        /**
+         * Call the function only for the array with the provided index
+         */
+        template< typename T_Func >
+        void visit( const std::size_t index, T_Func&& func ) {
+            ((index == T_Indices ? (func( get<T_Indices>() ), true) : false) || ...);
+        }
+    };
+}
+
+
+/**
+ * Templated Size Class Pool
+ * Segregated pool, that holds a separate allocation array for each size class
+ * The class an object is stored in is selected at compile time based on its
+ * size, so small objects do not waste the room of a large cell
+ * Objects that do not fit into the largest class are allocated on the heap
+ * and delete themselves like objects of the HeapAllocator
+ *
+ * @tparam T_Array - Alias template of the allocation array to use for a cell size
+ */
+template< template<std::size_t> class T_Array >
+class SizeClassPool {
+private:
+    using T_Classes= SizeClassPoolDetail::ClassSet< T_Array, std::make_index_sequence< SizeClassPoolDetail::T_classCount > >;
+
+    T_Classes m_classes;
+
+public:
+    explicit SizeClassPool( const unsigned int s, BlockSource& src= BlockSource::heap() )
+            : m_classes( s, src ) {}
+
+    SizeClassPool( const SizeClassPool& )= delete;
+
+    template< typename T_Element, typename ... T_Args >
+    T_Element* createPooled( T_Args&& ... args ) {
+        constexpr int index= SizeClassPoolDetail::findClass( sizeof(T_Element), alignof(T_Element) );
+
+        if constexpr ( index < 0 ) {
+            // Large objects do not get a deallocator and are deleted instead
+            return new T_Element( nullptr, std::forward<T_Args>(args)... );
+
+        } else {
+            return m_classes.template get<index>().template createPooled<T_Element>( std::forward<T_Args>(args)... );
+        }
+    }
+
+    template< typename T_Element, typename ... T_Args >
+    void createPooledN( T_Element** objects, const std::size_t num, const T_Args& ... args ) {
+        constexpr int index= SizeClassPoolDetail::findClass( sizeof(T_Element), alignof(T_Element) );
+
+        if constexpr ( index < 0 ) {
+            for( std::size_t i= 0; i!= num; i++ ) {
+                objects[i]= new T_Element( nullptr, args... );
+            }
+
+        } else {
+            m_classes.template get<index>().template createPooledN<T_Element>( objects, num, args... );
+        }
+    }
+
+    /**
+     * Fetch uninitialized memory of the provided size, which is aligned for any
+     * scalar type. The class is selected at runtime, requests that are too large
+     * for any class are allocated on the heap
+     */
+    void* allocateBytes( const std::size_t size ) {
+        const int index= SizeClassPoolDetail::findClass( size, SizeClassPoolDetail::T_classAlign );
+        if( index < 0 ) {
+            return ::operator new( size );
+        }
+
+        void* ptr= nullptr;
+        m_classes.visit( index, [&ptr]( auto& c ) { ptr= c.allocateCell(); } );
+        return ptr;
+    }
+
+    /**
+     * Return memory fetched by 'allocateBytes', the size has to be the same
+     */
+    void freeBytes( void* ptr, const std::size_t size ) {
+        const int index= SizeClassPoolDetail::findClass( size, SizeClassPoolDetail::T_classAlign );
+        if( index < 0 ) {
+            ::operator delete( ptr );
+            return;
+        }
+
+        m_classes.visit( index, [ptr]( auto& c ) { c.freeCell( ptr ); } );
+    }
+
+    /**
+     * Return all cells cached by the calling thread in any of the classes
+     * Only available if the arrays are cached
+     */
+    void flushThreadCache() {
+        m_classes.forEach( []( auto& c ) { c.flushThreadCache(); } );
+    }
+
+    /**
+     * Release the empty blocks of all classes
+     * @return Number of blocks released
+     */
+    std::size_t trim() {
+        return m_classes.sum( []( auto& c ) { return c.trim(); } );
+    }
+
+    /**
+     * Reserve room for the provided number of objects in every class
+     */
+    void reserve( const std::size_t num ) {
+        m_classes.forEach( [num]( auto& c ) { c.reserve( num ); } );
+    }
+
+    template< std::size_t T_Index >
+    inline auto& getClass() {
+        return m_classes.template get<T_Index>();
+    }
+
+    static constexpr std::size_t classCount() {
+        return SizeClassPoolDetail::T_classCount;
+    }
+};
+
+
+#endif //PROMISE_SIZECLASSPOOL_H
@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 26.09.2019.
+//
+
+#include "SmallVector.h"
\ No newline at end of file
@@ -0,0 +1,387 @@
+//
+// Created by Matthias Preymann on 26.09.2019.
+//
+
+#ifndef PROMISE_SMALLVECTOR_H
+#define PROMISE_SMALLVECTOR_H
+
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+
+namespace SmallVectorDetail {
+    /**
+     * Templated Trivially Relocatable Trait
+     * A type is trivially relocatable if moving an object to a new address and
+     * destroying the original is equivalent to copying its bytes. This is true for
+     * all trivially copyable types, and for some types that own a resource by pointer
+     * Specialize it for own types, that do not store pointers into themselves
+     *
+     * @tparam T - Type to check
+     */
+    template< typename T >
+    struct IsTriviallyRelocatable : std::is_trivially_copyable< T > {};
+
+    template< typename T, typename T_Deleter >
+    struct IsTriviallyRelocatable< std::unique_ptr< T, T_Deleter > > : IsTriviallyRelocatable< T_Deleter > {};
+
+    template< typename T >
+    struct IsTriviallyRelocatable< std::shared_ptr< T > > : std::true_type {};
+
+    template< typename T >
+    struct IsTriviallyRelocatable< std::weak_ptr< T > > : std::true_type {};
+}
+
+
+/**
+ * Templated Small Vector Class
+ * Implements a dynamic array, that stores up to T_localSize objects locally without
+ * making any allocation. Once more objects are added the elements are moved to an
+ * allocated buffer, which grows in multiples of 2
+ * Elements of trivially relocatable types are moved with memcpy when the buffer
+ * changes, all other types are move constructed and the originals are destroyed
+ *
+ * Detail: The max number of objects that can be stored is size_t / 2 as one
+ * of the bits of the length variable is used as a flag (local / dynamic alloc)
+ *
+ * @tparam T_Element      - Type of object to store
+ * @tparam T_localSizeDef - Number of objects to store locally: if the parameter
+ *                          is 0 (default) the maximal number of objects that can
+ *                          be stored without increasing the size of the class
+ *                          is calculated (at least one)
+ */
+template< typename T_Element, unsigned int T_localSizeDef= 0 >
+class SmallVector {
+private:
+
+    using T_ElementContainer = typename std::aligned_storage< sizeof(T_Element), alignof(T_Element) >::type;
+
+    struct T_DynamicDataType {
+        T_ElementContainer *m_data;
+        std::size_t m_size;
+    };
+
+    static constexpr size_t T_fittingLocalSize= sizeof(struct T_DynamicDataType) / sizeof(T_ElementContainer);
+    static constexpr size_t T_defaultLocalSize= (T_fittingLocalSize < 1) ? 1 : T_fittingLocalSize;
+    static constexpr size_t T_localSize= (T_localSizeDef < 1) ? T_defaultLocalSize : T_localSizeDef;
+
+    static constexpr bool T_relocatable= SmallVectorDetail::IsTriviallyRelocatable< T_Element >::value;
+
+
+    union {
+        struct T_DynamicDataType m_dynamic;
+
+        struct {
+            T_ElementContainer m_data[ T_localSize ];
+        }  m_local;
+
+    } m_inner;
+
+    std::size_t m_length;
+
+
+    inline bool isLocal() const {
+        return static_cast<bool>(m_length & 0x1);
+    }
+
+    inline void setLength( const std::size_t n ) {
+        m_length= (n << 1) | (m_length & 0x1);
+    }
+
+    inline T_ElementContainer* storage() {
+        return isLocal() ? m_inner.m_local.m_data : m_inner.m_dynamic.m_data;
+    }
+
+    inline const T_ElementContainer* storage() const {
+        return isLocal() ? m_inner.m_local.m_data : m_inner.m_dynamic.m_data;
+    }
+
+    static void relocate( T_ElementContainer* const block, T_ElementContainer* const elements, const std::size_t sz ) {
+        if constexpr ( T_relocatable ) {
+            std::memcpy( static_cast<void*>( block ), static_cast<const void*>( elements ), sz* sizeof(T_ElementContainer) );
+
+        } else {
+            // Create new elements by move constructor and destroy the old ones
+            auto src= reinterpret_cast<T_Element*>( elements );
+            for( size_t i= 0; i!= sz; i++ ) {
+                new( block + i ) T_Element( std::move( src[i] ) );
+                src[i].~T_Element();
+            }
+        }
+    }
+
+    void reallocate( const std::size_t cap ) {
+        const auto len= size();
+
+        // Move back into the local buffer if possible
+        if( cap <= T_localSize ) {
+            if( !isLocal() ) {
+                // The local buffer overlays the pointer to the block
+                auto block= m_inner.m_dynamic.m_data;
+                relocate( m_inner.m_local.m_data, block, len );
+                delete[] block;
+                m_length |= 0x1;
+            }
+
+            return;
+        }
+
+        auto block= new T_ElementContainer[ cap ];
+        relocate( block, storage(), len );
+
+        if( !isLocal() ) {
+            delete[] m_inner.m_dynamic.m_data;
+        }
+
+        m_inner.m_dynamic.m_data= block;
+        m_inner.m_dynamic.m_size= cap;
+        m_length &= ~static_cast<std::size_t>(0x1);
+    }
+
+    void grow( const std::size_t minCap ) {
+        const auto cap= 2* capacity();
+        reallocate( cap < minCap ? minCap : cap );
+    }
+
+    void destroyRange( T_Element* first, T_Element* const last ) {
+        if constexpr ( !std::is_trivially_destructible< T_Element >::value ) {
+            for( ; first!= last; first++ ) {
+                first->~T_Element();
+            }
+        }
+    }
+
+    /**
+     * Take over the elements of another vector, this vector has to be empty and local
+     */
+    void take( SmallVector&& other ) {
+        if( other.isLocal() ) {
+            relocate( m_inner.m_local.m_data, other.m_inner.m_local.m_data, other.size() );
+
+        } else {
+            m_inner.m_dynamic= other.m_inner.m_dynamic;
+            m_length &= ~static_cast<std::size_t>(0x1);
+        }
+
+        setLength( other.size() );
+        other.m_length= 0x1;
+    }
+
+    void release() {
+        clear();
+
+        if( !isLocal() ) {
+            delete[] m_inner.m_dynamic.m_data;
+            m_length= 0x1;
+        }
+    }
+
+public:
+    using value_type= T_Element;
+    using size_type= std::size_t;
+    using reference= T_Element&;
+    using const_reference= const T_Element&;
+    using iterator= T_Element*;
+    using const_iterator= const T_Element*;
+
+    SmallVector()
+    : m_length(0x1) {}
+
+    SmallVector( std::initializer_list< T_Element > list )
+    : m_length(0x1) {
+        reserve( list.size() );
+        for( auto& e : list ) {
+            push_back( e );
+        }
+    }
+
+    SmallVector( const SmallVector& other )
+    : m_length(0x1) {
+        reserve( other.size() );
+        for( auto& e : other ) {
+            push_back( e );
+        }
+    }
+
+    SmallVector( SmallVector&& other ) noexcept
+    : m_length(0x1) {
+        take( std::move( other ) );
+    }
+
+    ~SmallVector() {
+        release();
+    }
+
+    SmallVector& operator=( const SmallVector& other ) {
+        if( this != &other ) {
+            clear();
+            reserve( other.size() );
+            for( auto& e : other ) {
+                push_back( e );
+            }
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=( SmallVector&& other ) noexcept {
+        if( this != &other ) {
+            release();
+            take( std::move( other ) );
+        }
+
+        return *this;
+    }
+
+    inline size_t size() const {
+        return m_length >> 1;
+    }
+
+    inline bool empty() const {
+        return !size();
+    }
+
+    inline size_t capacity() const {
+        return isLocal() ? T_localSize : m_inner.m_dynamic.m_size;
+    }
+
+    inline T_Element* data() {
+        return reinterpret_cast<T_Element*>( storage() );
+    }
+
+    inline const T_Element* data() const {
+        return reinterpret_cast<const T_Element*>( storage() );
+    }
+
+    inline iterator begin() { return data(); }
+    inline iterator end() { return data()+ size(); }
+    inline const_iterator begin() const { return data(); }
+    inline const_iterator end() const { return data()+ size(); }
+    inline const_iterator cbegin() const { return data(); }
+    inline const_iterator cend() const { return data()+ size(); }
+
+    inline T_Element& operator[]( const std::size_t i ) { return data()[i]; }
+    inline const T_Element& operator[]( const std::size_t i ) const { return data()[i]; }
+
+    T_Element& at( const std::size_t i ) {
+        if( i >= size() ) {
+            throw std::out_of_range("Small Vector index out of range!");
+        }
+
+        return data()[i];
+    }
+
+    const T_Element& at( const std::size_t i ) const {
+        if( i >= size() ) {
+            throw std::out_of_range("Small Vector index out of range!");
+        }
+
+        return data()[i];
+    }
+
+    inline T_Element& front() { return data()[0]; }
+    inline const T_Element& front() const { return data()[0]; }
+    inline T_Element& back() { return data()[ size()- 1 ]; }
+    inline const T_Element& back() const { return data()[ size()- 1 ]; }
+
+    /**
+     * Make room for at least the provided number of elements
+     */
+    void reserve( const std::size_t cap ) {
+        if( cap > capacity() ) {
+            reallocate( cap );
+        }
+    }
+
+    /**
+     * Reduce the buffer to the number of elements, which moves them back
+     * into the local buffer if they fit
+     */
+    void shrink_to_fit() {
+        if( !isLocal() && size() < capacity() ) {
+            reallocate( size() );
+        }
+    }
+
+    template< typename ...T_Args >
+    T_Element& emplace_back( T_Args&& ... args ) {
+        const auto len= size();
+
+        if( len == capacity() ) {
+            // The arguments might refer to an element, so construct before growing
+            T_Element tmp( std::forward<T_Args>( args )... );
+            grow( len+ 1 );
+            new( storage()+ len ) T_Element( std::move( tmp ) );
+
+        } else {
+            new( storage()+ len ) T_Element( std::forward<T_Args>( args )... );
+        }
+
+        setLength( len+ 1 );
+        return data()[ len ];
+    }
+
+    inline void push_back( const T_Element& e ) {
+        emplace_back( e );
+    }
+
+    inline void push_back( T_Element&& e ) {
+        emplace_back( std::move( e ) );
+    }
+
+    void pop_back() {
+        const auto len= size()- 1;
+        data()[ len ].~T_Element();
+        setLength( len );
+    }
+
+    void resize( const std::size_t n ) {
+        const auto len= size();
+
+        if( n < len ) {
+            destroyRange( data()+ n, data()+ len );
+
+        } else {
+            reserve( n );
+            for( auto i= len; i!= n; i++ ) {
+                new( storage()+ i ) T_Element();
+            }
+        }
+
+        setLength( n );
+    }
+
+    /**
+     * Remove a range of elements and move the following ones forward
+     * @return Iterator to the element after the removed ones
+     */
+    iterator erase( const_iterator first, const_iterator last ) {
+        auto dst= begin()+ (first- cbegin());
+        auto src= begin()+ (last- cbegin());
+
+        if( dst != src ) {
+            auto newEnd= std::move( src, end(), dst );
+            destroyRange( newEnd, end() );
+            setLength( newEnd- begin() );
+        }
+
+        return dst;
+    }
+
+    inline iterator erase( const_iterator pos ) {
+        return erase( pos, pos+ 1 );
+    }
+
+    void clear() {
+        destroyRange( begin(), end() );
+        setLength( 0 );
+    }
+};
+
+#endif //PROMISE_SMALLVECTOR_H
@@ -0,0 +1,42 @@
+//
+// Created by Matthias Preymann on 10.10.2019.
+//
+
+#include "SpinWait.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+void SpinWait::pause() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile( "yield" );
+#endif
+}
+
+void SpinWait::adapt( const bool success ) {
+    const auto spins= m_spins.load( std::memory_order_relaxed );
+
+    if( success ) {
+        const auto maxSpins= m_maxSpins.load( std::memory_order_relaxed );
+        m_spins.store( spins* 2 < maxSpins ? spins* 2 : maxSpins, std::memory_order_relaxed );
+
+    } else {
+        const auto minSpins= this->minSpins();
+        m_spins.store( spins/ 2 > minSpins ? spins/ 2 : minSpins, std::memory_order_relaxed );
+    }
+}
+
+void SpinWait::setPolicy( const WaitPolicy& p ) {
+    m_maxSpins.store( p.m_spins, std::memory_order_relaxed );
+    m_yields.store( p.m_yields, std::memory_order_relaxed );
+    m_spins.store( p.m_spins, std::memory_order_relaxed );
+}
+
+WaitPolicy SpinWait::getPolicy() const {
+    return WaitPolicy{ m_maxSpins.load( std::memory_order_relaxed ), m_yields.load( std::memory_order_relaxed ) };
+}
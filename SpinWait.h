@@ -0,0 +1,93 @@
+//
+// Created by Matthias Preymann on 10.10.2019.
+//
+
+#ifndef PROMISE_SPINWAIT_H
+#define PROMISE_SPINWAIT_H
+
+#include <atomic>
+#include <thread>
+
+
+/**
+ * Wait Policy Struct
+ * How long a consumer keeps looking for work before it parks
+ * m_spins:  Max number of checks with a pause instruction in between
+ * m_yields: Number of checks with a yield of the thread in between, that follow the spins
+ * Zero for both parks right away
+ */
+struct WaitPolicy {
+    unsigned int m_spins;
+    unsigned int m_yields;
+};
+
+
+/**
+ * Spin Wait Class
+ * Polls a condition first by spinning, then by yielding the thread, before the
+ * caller has to park. The number of spins adapts to the load: It doubles every
+ * time the condition became true while spinning and halves every time the caller
+ * has to park, but stays between a sixteenth of the maximum and the maximum of
+ * the policy
+ * The policy can be changed while other threads wait
+ */
+class SpinWait {
+private:
+    std::atomic< unsigned int > m_maxSpins;
+    std::atomic< unsigned int > m_yields;
+    std::atomic< unsigned int > m_spins;
+
+    static void pause();
+
+    inline unsigned int minSpins() const {
+        return (m_maxSpins.load( std::memory_order_relaxed )+ 15) / 16;
+    }
+
+    void adapt( bool success );
+
+public:
+    static constexpr WaitPolicy T_defaultPolicy{ 1024, 8 };
+
+    explicit SpinWait( const WaitPolicy& p= T_defaultPolicy )
+            : m_maxSpins( p.m_spins ), m_yields( p.m_yields ), m_spins( p.m_spins ) {}
+
+    void setPolicy( const WaitPolicy& p );
+
+    WaitPolicy getPolicy() const;
+
+    /**
+     * Poll the functor until it returns true or the policy is exhausted
+     * @return False if the caller should park
+     */
+    template< typename T_Func >
+    bool wait( T_Func&& ready ) {
+        const auto spins= m_spins.load( std::memory_order_relaxed );
+        for( unsigned int i= 0; i!= spins; i++ ) {
+            if( ready() ) {
+                adapt( true );
+                return true;
+            }
+
+            pause();
+        }
+
+        const auto yields= m_yields.load( std::memory_order_relaxed );
+        for( unsigned int i= 0; i!= yields; i++ ) {
+            if( ready() ) {
+                return true;
+            }
+
+            std::this_thread::yield();
+        }
+
+        if( ready() ) {
+            return true;
+        }
+
+        adapt( false );
+        return false;
+    }
+};
+
+
+#endif //PROMISE_SPINWAIT_H
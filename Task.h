@@ -7,18 +7,41 @@
 
 #include "Worker.h"
 #include "ObjectPool.h"
+#include "Priority.h"
 
 
 /**
  * Abstract Task Class
  * Interface for code to be run on a worker thread
+ * The priority is set when the task is submitted, and is passed on to
+ * the events the task sends
  */
 class Task : public PooledObject {
+private:
+    Priority m_priority;
+
 public:
+    // Error code passed to reject events of tasks that were not accepted
+    static constexpr int T_queueFullError= -2;
+
     Task( Deallocator* d )
-            : PooledObject( d ) {}
+            : PooledObject( d ), m_priority( Priority::Normal ) {}
     virtual ~Task() = default;
     virtual void execute( Worker::WorkerInterface& ) = 0;
+
+    inline Priority getPriority() const {
+        return m_priority;
+    }
+
+    inline void setPriority( const Priority p ) {
+        m_priority= p;
+    }
+
+    /**
+     * Called on the submitting thread instead of 'execute' if the worker pool
+     * did not accept the task, because its queue is full
+     */
+    virtual void reject( EventLoop& ) {}
 };
 
 
@@ -6,21 +6,22 @@
 #include "EventLoop.h"
 #include "Console.h"
 
-Timer::Timer( EventLoop &el )
-        : m_enable(true), m_eventList(T_listBucketSize), m_eventLoop(el), m_thread( Timer::run, this ) {}
+Timer::Timer( EventLoop &el, TimingWheel::T_Duration tick, Mode mode )
+        : m_enable(true), m_mode(mode), m_wheel(tick), m_eventLoop(el),
+          m_thread( mode == Mode::Thread ? std::thread( &Timer::run, this ) : std::thread() ) {}
 
 void Timer::run() {
     std::unique_lock<std::mutex> m_lock(m_mutex);
 
-    while( true ) {
-        // If the list has an event, wait until it is ready
-        if( m_eventList.isEmpty() ) {
+    while( m_enable ) {
+        // If the wheel has an event, wait until it has to be turned
+        if( m_wheel.isEmpty() ) {
             //Console::println("Tmr: No events to wait for...");
             m_cvar.wait( m_lock );
 
         } else {
             //Console::println("Tmr: wait for event to be ready...");
-            m_cvar.wait_until( m_lock, m_eventList.front().getTime() );
+            m_cvar.wait_until( m_lock, m_wheel.nextDeadline() );
         }
 
         // Stop
@@ -29,48 +30,129 @@ void Timer::run() {
         }
 
         // Dispatch any ready events
-        dispatchEvents();
+        dispatchEvents( m_lock );
     }
 
     Console::println("Timer stopped...");
 }
 
-void Timer::addTimedEvent( std::chrono::milliseconds ms, PoolPointer<Event> e ) {
+void Timer::notifyIfEarlier( T_TimePoint previous ) {
+    // The thread only has to wake up if it waits for a later point in time
+    if( m_wheel.nextDeadline() < previous ) {
+        if( isInline() ) {
+            m_eventLoop.wakeUp();
+        } else {
+            m_cvar.notify_all();
+        }
+    }
+}
+
+Timer::Handle Timer::addTimedEvent( std::chrono::milliseconds ms, PoolPointer<Event> e, std::chrono::milliseconds slack ) {
     std::lock_guard<std::mutex> lock(m_mutex);
+    const auto previous= m_wheel.nextDeadline();
 
     // Calculate absolute time stamp from current time and the provided offset
-    T_TimePoint t= std::chrono::system_clock::now() + ms;
-    m_eventList.insert( PendingEvent( std::move(e), t ) );
+    T_TimePoint t= TimingWheel::T_Clock::now() + ms;
+    auto h= m_wheel.add( t, std::move(e), T_Duration::zero(), slack );
+
+    notifyIfEarlier( previous );
+
+    return h;
+}
+
+bool Timer::cancel( const Handle& h ) {
+    // The thread does not need to wake up, it just finds nothing to do
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_wheel.cancel( h );
+}
+
+bool Timer::reschedule( const Handle& h, std::chrono::milliseconds ms ) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto previous= m_wheel.nextDeadline();
+
+    T_TimePoint t= TimingWheel::T_Clock::now() + ms;
+    if( !m_wheel.reschedule( h, t ) ) {
+        return false;
+    }
+
+    notifyIfEarlier( previous );
+    return true;
+}
+
+void Timer::dispatchEvents( std::unique_lock<std::mutex>& lock ) {
+    // Collect all events that are ready now with a single look at the clock
+    m_wheel.advance( TimingWheel::T_Clock::now(), [this]( PoolPointer<Event> e ) {
+        m_expired.push_back( std::move(e) );
+    } );
+
+    if( m_expired.empty() ) {
+        return;
+    }
+
+    // Hand them to the event loop without blocking other threads adding events
+    lock.unlock();
+
+    m_eventLoop.sendEvents( m_expired.data(), m_expired.size() );
+    m_expired.clear();
+
+    lock.lock();
+}
 
-    // Notify the thread to wake up
-    m_cvar.notify_all();
+Timer::Handle Timer::setInterval( std::chrono::milliseconds period, PoolPointer<IntervalEvent> e, std::chrono::milliseconds slack ) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto previous= m_wheel.nextDeadline();
+
+    // The event has to know its handle before it can be sent
+    auto ev= e.get();
+    T_TimePoint t= TimingWheel::T_Clock::now() + period;
+    auto h= m_wheel.add( t, std::move(e), period, slack );
+    ev->m_handle= h;
+
+    notifyIfEarlier( previous );
+
+    return h;
 }
 
-void Timer::dispatchEvents() {
-    // Dispatch all events that are ready now
-    while( !m_eventList.isEmpty() ) {
-        auto& pending= m_eventList.front();
+void Timer::rearm( const Handle& h, PoolPointer<Event> e ) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto previous= m_wheel.nextDeadline();
 
-        // If the next event is not ready yet, go back waiting
-        if( !pending.isReady() ) {
-            //Console::println("Tmr: No events to dispatch!");
+        if( m_wheel.rearm( h, e ) ) {
+            notifyIfEarlier( previous );
             return;
         }
-
-        // Send the event and remove it from the list
-        //Console::println( "Tmr: Dispatch" );
-        pending.send( m_eventLoop );
-        m_eventList.popFront();
     }
+
+    // The interval was cancelled, destroy the event without holding the lock
+    e.reset();
+}
+
+Timer::T_TimePoint Timer::nextDeadline() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_wheel.nextDeadline();
 }
 
 void Timer::stop() {
     // Set the enable flag to false and notify the thread
-    m_enable= false;
-    m_cvar.notify_all();
-    m_thread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_enable= false;
+        m_cvar.notify_all();
+    }
+
+    if( m_thread.joinable() ) {
+        m_thread.join();
+    }
 }
 
-void Timer::PendingEvent::send(EventLoop &el) {
-    el.sendEvent( std::move( m_event ) );
+void IntervalEvent::execute( EventLoop& l ) {
+    tick( l );
+
+    // Take the event from the loop and hand it back, which might destroy it
+    auto self= l.getEventHandle();
+    if( self ) {
+        auto h= m_handle;
+        l.getTimer().rearm( h, std::move(self) );
+    }
 }
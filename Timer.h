@@ -12,68 +12,177 @@
 #include <vector>
 #include <chrono>
 #include "Event.h"
-#include "PooledSortedList.h"
+#include "TimingWheel.h"
+#include "SmallVector.h"
 
 class EventLoop;
+class IntervalEvent;
 
 /**
  * Timer Class
  * Runs a sleeping thread that either wakes up when new events
  * are added to its queue or an event is ready to be sent back
  * to the event loop
+ * Pending events are kept in a timing wheel, whose tick is the
+ * resolution of the timer. Events that expire together are sent
+ * to the event loop as one batch with a single lock of its queue
+ * after the lock of the timer is released, and
+ * the thread is only woken up if its next deadline moved forward
+ * Adding an event returns a handle, which allows to cancel or
+ * reschedule it until it is sent
+ * Interval events are sent repeatedly with a fixed period. After
+ * every run they hand themselves back to be re-armed, so no event
+ * is allocated per repetition
+ * In inline mode no thread is started. Instead the event loop waits
+ * for the next deadline itself and runs expired events directly
  */
 class Timer {
+public:
+    enum class Mode {
+        Thread,
+        Inline
+    };
+
 private:
-    static constexpr size_t T_listBucketSize= 32;
-    using T_TimePoint= std::chrono::system_clock::time_point;
+    using T_TimePoint= TimingWheel::T_TimePoint;
+    using T_Duration= TimingWheel::T_Duration;
+
+    static constexpr unsigned int T_batchLocalSize= 16;
+
+    bool m_enable;
+    const Mode m_mode;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cvar;
+
+    TimingWheel m_wheel;
+
+    // Only used by the thread sending the expired events
+    SmallVector< PoolPointer<Event>, T_batchLocalSize > m_expired;
+
+    EventLoop& m_eventLoop;
+
+    // Started last, as the thread uses all the other members
+    std::thread m_thread;
+
+    void dispatchEvents( std::unique_lock<std::mutex>& lock );
+
+    void notifyIfEarlier( T_TimePoint previous );
+
+public:
+    using Handle= TimingWheel::Handle;
+
+    explicit Timer( EventLoop& el, TimingWheel::T_Duration tick= TimingWheel::T_defaultTick, Mode mode= Mode::Thread );
+
+    inline bool isInline() const {
+        return m_mode == Mode::Inline;
+    }
+
+    /**
+     * Send the event after the provided time
+     * The event may be sent up to the slack later, so that it can be sent
+     * together with other events
+     */
+    Handle addTimedEvent( std::chrono::milliseconds ms, PoolPointer<Event> e,
+                          std::chrono::milliseconds slack= std::chrono::milliseconds( 0 ) );
 
     /**
-     * Internal Pending Event Class
-     * Holds the event pointer and the time stamp when its ready
+     * Remove a pending event, which is destroyed right away
+     * @return False if the event was already sent or cancelled
      */
-    class PendingEvent {
-    private:
-        PoolPointer<Event> m_event;
-        T_TimePoint m_timePoint;
+    bool cancel( const Handle& h );
 
-    public:
-        PendingEvent( PoolPointer<Event> e, T_TimePoint t )
-                : m_event( std::move(e) ), m_timePoint( t ) {}
+    /**
+     * Change the time a pending event is sent to the provided offset from now
+     * @return False if the event was already sent or cancelled
+     */
+    bool reschedule( const Handle& h, std::chrono::milliseconds ms );
 
-        inline const T_TimePoint& getTime() const { return m_timePoint; }
+    /**
+     * Send the event every period, starting one period from now
+     * The handle stays valid for all repetitions until it is cancelled
+     */
+    Handle setInterval( std::chrono::milliseconds period, PoolPointer<IntervalEvent> e,
+                        std::chrono::milliseconds slack= std::chrono::milliseconds( 0 ) );
 
-        inline bool isReady() const {
-            return (std::chrono::system_clock::now() >= m_timePoint );
+    /**
+     * Hand back an interval event after it was run
+     * If the interval was cancelled meanwhile the event is destroyed
+     */
+    void rearm( const Handle& h, PoolPointer<Event> e );
+
+    /**
+     * Point in time the event loop has to call 'expireInline' next
+     * Only used in inline mode
+     */
+    T_TimePoint nextDeadline();
+
+    /**
+     * Take all expired events and pass them to the functor without holding the lock
+     * Only used in inline mode by the event loop thread
+     */
+    template< typename T_Func >
+    void expireInline( T_Func&& func ) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wheel.advance( TimingWheel::T_Clock::now(), [this]( PoolPointer<Event> e ) {
+                m_expired.push_back( std::move(e) );
+            } );
         }
 
-        // Operator '>' needed for sorting
-        inline bool operator>( const PendingEvent& x ) {
-            return (this->m_timePoint > x.m_timePoint);
+        for( auto& e : m_expired ) {
+            func( std::move(e) );
         }
+        m_expired.clear();
+    }
 
-        void send( EventLoop& el );
-    };
+    void run();
 
-    bool m_enable;
+    void stop();
+};
 
-    std::thread m_thread;
-    std::mutex m_mutex;
-    std::condition_variable m_cvar;
 
-    PooledSortedList< PendingEvent > m_eventList;
+/**
+ * Abstract Interval Event Class
+ * Event that is sent repeatedly by the timer. After every run it takes itself
+ * from the event loop and hands itself back to the timer to be re-armed
+ */
+class IntervalEvent : public Event {
+private:
+    friend class Timer;
 
-    EventLoop& m_eventLoop;
+    Timer::Handle m_handle;
 
-    void dispatchEvents();
+protected:
+    virtual void tick( EventLoop& )= 0;
 
 public:
-    explicit Timer( EventLoop& el );
+    IntervalEvent( Deallocator* d )
+            : Event( d ) {}
 
-    void addTimedEvent( std::chrono::milliseconds ms, PoolPointer<Event> e );
+    inline const Timer::Handle& getHandle() const { return m_handle; }
 
-    void run();
+    void execute( EventLoop& l ) final;
+};
 
-    void stop();
+
+/**
+ * Templated Function Interval Event Class
+ * Allowing the repeated execution of a Lambda which is held by value
+ * @tparam T_Lambda - Lambda Type to be stored
+ */
+template <typename  T_Lambda>
+class FunctionIntervalEvent : public IntervalEvent {
+protected:
+    LambdaContainer<T_Lambda> m_function;
+
+    void tick( EventLoop& loop ) override {
+        m_function.get()( loop );
+    }
+
+public:
+    FunctionIntervalEvent( Deallocator* d, T_Lambda&& fn )
+            : IntervalEvent( d ), m_function( std::forward<T_Lambda>(fn) ) {}
 };
 
 
@@ -0,0 +1,287 @@
+//
+// Created by Matthias Preymann on 02.10.2019.
+//
+
+#include "TimingWheel.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+TimingWheel::TimingWheel( T_Duration tick, T_TimePoint start )
+        : m_tick( tick ), m_start( start ), m_current( 0 ), m_pool( T_entryBucketSize ), m_occupied{}, m_size( 0 ), m_nextId( 1 ) {
+    if( m_tick <= T_Duration::zero() ) {
+        throw std::runtime_error("Tick of Timing Wheel has to be positive.");
+    }
+
+    // All slots and the list of parked entries
+    for( std::uint64_t i= 0; i!= T_parkedSlot+ 1; i++ ) {
+        m_slots.emplace_back( m_pool );
+    }
+}
+
+unsigned int TimingWheel::countTrailingZeros( std::uint64_t x ) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64( &index, x );
+    return static_cast<unsigned int>( index );
+#else
+    return static_cast<unsigned int>( __builtin_ctzll( x ) );
+#endif
+}
+
+unsigned int TimingWheel::highestBit( std::uint64_t x ) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64( &index, x );
+    return static_cast<unsigned int>( index );
+#else
+    return 63- static_cast<unsigned int>( __builtin_clzll( x ) );
+#endif
+}
+
+std::uint64_t TimingWheel::applySlack( const std::uint64_t expiry, const std::uint64_t slack ) {
+    if( !slack ) {
+        return expiry;
+    }
+
+    // Clear all bits below the highest one that differs between the tick before the
+    // window and the latest allowed tick, which is the coarsest tick inside the window.
+    // This might be the expiry itself. Expiries are never zero
+    const auto latest= expiry+ slack;
+    const auto mask= (std::uint64_t(1) << highestBit( (expiry- 1) ^ latest )) - 1;
+    return latest & ~mask;
+}
+
+std::uint64_t TimingWheel::tickOf( T_TimePoint t ) const {
+    if( t <= m_start ) {
+        return 0;
+    }
+
+    return static_cast<std::uint64_t>( (t- m_start) / m_tick );
+}
+
+TimingWheel::T_TimePoint TimingWheel::timeOf( std::uint64_t tick ) const {
+    return m_start+ m_tick* tick;
+}
+
+std::uint64_t TimingWheel::expiryOf( T_TimePoint deadline ) const {
+    // Events are never added to a tick that was already processed
+    auto expiry= tickOf( deadline );
+    if( m_tick* expiry+ m_start < deadline ) {
+        expiry++;
+    }
+    if( expiry <= m_current ) {
+        expiry= m_current+ 1;
+    }
+
+    return expiry;
+}
+
+TimingWheel::T_Slot::Handle TimingWheel::entryOf( const Handle& h ) const {
+    // The record might be unused or reused for another event
+    if( !h || h.m_record >= m_records.size() || m_records[ h.m_record ].m_id != h.m_id ) {
+        return T_Slot::Handle();
+    }
+
+    return m_records[ h.m_record ].m_entry;
+}
+
+std::size_t TimingWheel::createRecord( const std::uint64_t id ) {
+    if( m_freeRecords.empty() ) {
+        m_records.push_back( Record{ T_Slot::Handle(), id } );
+        return m_records.size()- 1;
+    }
+
+    const auto r= m_freeRecords.back();
+    m_freeRecords.pop_back();
+    m_records[ r ].m_id= id;
+    return r;
+}
+
+void TimingWheel::place( T_Slot::Handle h ) {
+    // Deadlines out of range are parked in the farthest slot of the highest level
+    auto expiry= applySlack( h->m_expiry, h->m_slack );
+    if( expiry- m_current >= T_range ) {
+        expiry= m_current+ T_range- 1;
+    }
+
+    // Find the lowest level that reaches the deadline
+    const auto delta= expiry- m_current;
+    unsigned int level= 0;
+    while( level+ 1 < T_levelCount && delta >= (std::uint64_t(1) << (T_levelBits* (level+ 1))) ) {
+        level++;
+    }
+
+    const auto index= (expiry >> (T_levelBits* level)) & T_slotMask;
+    const auto srcSlot= h->m_slot;
+    auto& src= m_slots[ srcSlot ];
+    auto& dst= getSlot( level, index );
+
+    dst.splice( T_Slot::Handle(), src, h );
+    h->m_slot= static_cast<unsigned int>( level* T_slotCount+ index );
+    m_occupied[ level ] |= std::uint64_t(1) << index;
+
+    if( src.isEmpty() ) {
+        clearOccupied( srcSlot );
+    }
+}
+
+void TimingWheel::clearOccupied( const unsigned int slot ) {
+    if( slot != T_parkedSlot ) {
+        m_occupied[ slot / T_slotCount ] &= ~(std::uint64_t(1) << (slot & T_slotMask));
+    }
+}
+
+void TimingWheel::removeFromSlot( T_Slot::Handle h ) {
+    const auto slot= h->m_slot;
+    auto& list= m_slots[ slot ];
+
+    // Invalidate all handles before the cell goes back to the pool
+    auto& record= m_records[ h->m_record ];
+    record.m_entry= T_Slot::Handle();
+    record.m_id= 0;
+    m_freeRecords.push_back( h->m_record );
+    list.erase( h );
+
+    // Parked entries are not counted, as they do not wait for a deadline
+    if( slot != T_parkedSlot ) {
+        m_size--;
+    }
+
+    if( list.isEmpty() ) {
+        clearOccupied( slot );
+    }
+}
+
+void TimingWheel::park( T_Slot::Handle h ) {
+    const auto slot= h->m_slot;
+    auto& list= m_slots[ slot ];
+    auto& parked= m_slots[ T_parkedSlot ];
+
+    parked.splice( T_Slot::Handle(), list, h );
+    h->m_slot= T_parkedSlot;
+    m_size--;
+
+    if( list.isEmpty() ) {
+        clearOccupied( slot );
+    }
+}
+
+void TimingWheel::cascade( const unsigned int level ) {
+    const auto index= (m_current >> (T_levelBits* level)) & T_slotMask;
+    auto& slot= getSlot( level, index );
+
+    // Move all events of the slot to a lower level, they never end up in the same slot again
+    while( !slot.isEmpty() ) {
+        place( slot.frontHandle() );
+    }
+}
+
+std::uint64_t TimingWheel::nextTick() const {
+    auto next= static_cast<std::uint64_t>( -1 );
+
+    for( unsigned int level= 0; level!= T_levelCount; level++ ) {
+        const auto bits= m_occupied[ level ];
+        if( !bits ) {
+            continue;
+        }
+
+        // Find the first occupied slot after the current one, a full turn at most
+        const auto shift= T_levelBits* level;
+        const auto base= m_current >> shift;
+        const auto rotate= (base+ 1) & T_slotMask;
+        const auto rotated= rotate ? ((bits >> rotate) | (bits << (T_slotCount- rotate))) : bits;
+
+        const auto tick= (base+ 1+ countTrailingZeros( rotated )) << shift;
+        if( tick < next ) {
+            next= tick;
+        }
+    }
+
+    return next;
+}
+
+void TimingWheel::step() {
+    m_current++;
+
+    // Higher levels first, as their events might move into a slot of a lower level, that is due now
+    for( unsigned int level= T_levelCount- 1; level; level-- ) {
+        if( !(m_current & ((std::uint64_t(1) << (T_levelBits* level)) - 1)) ) {
+            cascade( level );
+        }
+    }
+}
+
+TimingWheel::Handle TimingWheel::add( T_TimePoint deadline, PoolPointer<Event> e, T_Duration period, T_Duration slack ) {
+    const auto id= m_nextId++;
+
+    // Repeating events have a period of at least a single tick
+    std::uint64_t ticks= 0;
+    if( period > T_Duration::zero() ) {
+        ticks= static_cast<std::uint64_t>( (period+ m_tick- T_Duration( 1 )) / m_tick );
+    }
+
+    // Create the entry in the slot at the current position and move it to the right one
+    auto& current= getSlot( 0, m_current & T_slotMask );
+    const auto slackTicks= static_cast<std::uint64_t>( slack > T_Duration::zero() ? slack / m_tick : 0 );
+    const auto record= createRecord( id );
+    auto h= current.pushBack( std::move(e), expiryOf( deadline ), ticks, slackTicks, record );
+    h->m_slot= static_cast<unsigned int>( m_current & T_slotMask );
+    m_records[ record ].m_entry= h;
+    m_size++;
+
+    place( h );
+
+    return Handle( record, id );
+}
+
+bool TimingWheel::cancel( const Handle& h ) {
+    const auto entry= entryOf( h );
+    if( !entry ) {
+        return false;
+    }
+
+    removeFromSlot( entry );
+    return true;
+}
+
+bool TimingWheel::rearm( const Handle& h, PoolPointer<Event>& e ) {
+    const auto handle= entryOf( h );
+    if( !handle || handle->m_slot != T_parkedSlot ) {
+        return false;
+    }
+
+    auto& entry= *handle;
+    entry.m_event= std::move( e );
+
+    // Stay in phase with the period, even if the event was late
+    entry.m_expiry+= entry.m_period;
+    if( entry.m_expiry <= m_current ) {
+        const auto missed= (m_current- entry.m_expiry) / entry.m_period+ 1;
+        entry.m_expiry+= missed* entry.m_period;
+    }
+
+    m_size++;
+    place( handle );
+    return true;
+}
+
+bool TimingWheel::reschedule( const Handle& h, T_TimePoint deadline ) {
+    const auto entry= entryOf( h );
+    if( !entry || entry->m_slot == T_parkedSlot ) {
+        return false;
+    }
+
+    entry->m_expiry= expiryOf( deadline );
+    place( entry );
+    return true;
+}
+
+TimingWheel::T_TimePoint TimingWheel::nextDeadline() const {
+    if( isEmpty() ) {
+        return T_TimePoint::max();
+    }
+
+    return timeOf( nextTick() );
+}
@@ -0,0 +1,261 @@
+//
+// Created by Matthias Preymann on 02.10.2019.
+//
+
+#ifndef PROMISE_TIMINGWHEEL_H
+#define PROMISE_TIMINGWHEEL_H
+
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "Event.h"
+#include "PooledDoublyLinkedList.h"
+
+
+/**
+ * Timing Wheel Class
+ * Hierarchical timing wheel, that stores events until their deadline has passed
+ * Time is divided into ticks of configurable length. Each level of the wheel has
+ * 64 slots, a slot of the lowest level covers a single tick and a slot of every
+ * further level covers all the slots of the level below. An event is put into the
+ * lowest level whose range reaches its deadline, and is moved down a level when
+ * the wheel turns past the slot it is in. Therefore inserting and expiring an event
+ * are O(1), independent of the number of pending events
+ * Deadlines beyond the range of the highest level are parked in its farthest slot
+ * until they come into range
+ * The slots are pooled doubly linked lists sharing a single pool, so moving an
+ * event between slots does not allocate. The wheel is not synchronised
+ * Every added event gets a handle to cancel or reschedule it in O(1). Handles
+ * refer to a record of the wheel, which holds the entry and its unique id. The
+ * records are never freed, only reused, and the id is cleared when the entry is
+ * removed. So a handle whose event already expired or was cancelled is detected
+ * without ever touching the pool cell the entry lived in
+ * Each event may have a slack, by which its expiry may be delayed. The expiry
+ * is then rounded to the coarsest tick inside that window, so events with
+ * nearby deadlines end up in the same tick and expire together
+ * Repeating events keep their entry while they are out of the wheel. The entry
+ * is parked in a separate list until the event is handed back and re-armed one
+ * period after its last expiry, so its handle stays valid for all repetitions
+ */
+class TimingWheel {
+public:
+    // Monotonic, so changes of the wall clock do not move deadlines
+    using T_Clock= std::chrono::steady_clock;
+    using T_TimePoint= T_Clock::time_point;
+    using T_Duration= T_Clock::duration;
+
+private:
+    static constexpr unsigned int T_levelBits= 6;
+    static constexpr unsigned int T_levelCount= 4;
+    static constexpr std::uint64_t T_slotCount= std::uint64_t(1) << T_levelBits;
+    static constexpr std::uint64_t T_slotMask= T_slotCount- 1;
+    static constexpr std::uint64_t T_range= std::uint64_t(1) << (T_levelBits* T_levelCount);
+    static constexpr size_t T_entryBucketSize= 32;
+
+    // Index of the list of repeating entries, whose event is currently out of the wheel
+    static constexpr unsigned int T_parkedSlot= T_levelCount* T_slotCount;
+
+    class Entry;
+    using T_Slot= PooledDoublyLinkedList< Entry >;
+
+    /**
+     * Internal Entry Class
+     * Holds the event, the tick it expires at, the period in ticks for repeating events,
+     * the slack in ticks, the index of the slot it is stored in and the index of the
+     * record that identifies the entry for handles
+     */
+    class Entry {
+    public:
+        PoolPointer<Event> m_event;
+        std::uint64_t m_expiry;
+        std::uint64_t m_period;
+        std::uint64_t m_slack;
+        std::size_t m_record;
+        unsigned int m_slot;
+
+        Entry( PoolPointer<Event> e, const std::uint64_t x, const std::uint64_t p, const std::uint64_t s, const std::size_t r )
+                : m_event( std::move(e) ), m_expiry( x ), m_period( p ), m_slack( s ), m_record( r ), m_slot( 0 ) {}
+    };
+
+    /**
+     * Internal Record Struct
+     * Entry of a pending event and its id, which is zero while the record is unused
+     */
+    struct Record {
+        T_Slot::Handle m_entry;
+        std::uint64_t m_id;
+    };
+
+public:
+    /**
+     * Handle Class
+     * Refers to a pending event of the wheel
+     */
+    class Handle {
+    private:
+        friend TimingWheel;
+
+        std::size_t m_record;
+        std::uint64_t m_id;
+
+        Handle( const std::size_t r, const std::uint64_t id )
+                : m_record( r ), m_id( id ) {}
+
+    public:
+        Handle()
+                : m_record( 0 ), m_id( 0 ) {}
+
+        explicit inline operator bool() const {
+            return m_id != 0;
+        }
+    };
+
+private:
+
+    const T_Duration m_tick;
+    const T_TimePoint m_start;
+
+    // Last tick that was processed
+    std::uint64_t m_current;
+
+    T_Slot::Pool m_pool;
+    std::deque< T_Slot > m_slots;
+    std::uint64_t m_occupied[ T_levelCount ];
+    std::size_t m_size;
+    std::uint64_t m_nextId;
+
+    std::vector< Record > m_records;
+    std::vector< std::size_t > m_freeRecords;
+
+    inline T_Slot& getSlot( const unsigned int level, const std::uint64_t index ) {
+        return m_slots[ level* T_slotCount+ index ];
+    }
+
+    static unsigned int countTrailingZeros( std::uint64_t x );
+
+    static unsigned int highestBit( std::uint64_t x );
+
+    static std::uint64_t applySlack( std::uint64_t expiry, std::uint64_t slack );
+
+    std::uint64_t tickOf( T_TimePoint t ) const;
+
+    T_TimePoint timeOf( std::uint64_t tick ) const;
+
+    std::uint64_t expiryOf( T_TimePoint deadline ) const;
+
+    /**
+     * Entry of the handle, a null handle if its event already expired or was cancelled
+     */
+    T_Slot::Handle entryOf( const Handle& h ) const;
+
+    std::size_t createRecord( std::uint64_t id );
+
+    void place( T_Slot::Handle h );
+
+    void clearOccupied( unsigned int slot );
+
+    void removeFromSlot( T_Slot::Handle h );
+
+    void park( T_Slot::Handle h );
+
+    void cascade( unsigned int level );
+
+    std::uint64_t nextTick() const;
+
+    void step();
+
+public:
+    static constexpr T_Duration T_defaultTick= std::chrono::milliseconds( 1 );
+
+    explicit TimingWheel( T_Duration tick= T_defaultTick, T_TimePoint start= T_Clock::now() );
+
+    TimingWheel( const TimingWheel& )= delete;
+
+    inline bool isEmpty() const {
+        return !m_size;
+    }
+
+    inline std::size_t getLength() const {
+        return m_size;
+    }
+
+    inline T_Duration getTick() const {
+        return m_tick;
+    }
+
+    /**
+     * Add an event, which is expired once its deadline has passed
+     * If a period is provided the event is repeating, and has to be handed back
+     * with 'rearm' after every expiry
+     * The event may expire up to the slack later than its deadline, if this allows
+     * to expire it together with others
+     */
+    Handle add( T_TimePoint deadline, PoolPointer<Event> e, T_Duration period= T_Duration::zero(),
+                T_Duration slack= T_Duration::zero() );
+
+    /**
+     * Put the event of a repeating entry back into the wheel
+     * The next deadline is exactly one period after the last one, periods that
+     * were missed entirely are skipped
+     * @return False if the entry was cancelled, the event is left untouched then
+     */
+    bool rearm( const Handle& h, PoolPointer<Event>& e );
+
+    /**
+     * Remove a pending event and destroy it right away
+     * @return False if the event already expired or was cancelled
+     */
+    bool cancel( const Handle& h );
+
+    /**
+     * Move a pending event to a new deadline
+     * @return False if the event already expired, was cancelled or is out of the wheel
+     */
+    bool reschedule( const Handle& h, T_TimePoint deadline );
+
+    /**
+     * Point in time the wheel has to be advanced next
+     * This is either the deadline of the next event or the time a higher level
+     * has to be moved down. Returns the maximum time point if the wheel is empty
+     */
+    T_TimePoint nextDeadline() const;
+
+    /**
+     * Turn the wheel up to the provided time and hand every expired event
+     * to the functor in order of their deadlines
+     */
+    template< typename T_Func >
+    void advance( const T_TimePoint now, T_Func&& func ) {
+        const auto target= tickOf( now );
+
+        while( m_current < target ) {
+            // Skip all ticks where nothing has to be done
+            const auto next= nextTick();
+            if( next > target ) {
+                m_current= target;
+                return;
+            }
+
+            m_current= next- 1;
+            step();
+
+            // Expire the events of the current tick
+            auto& slot= getSlot( 0, m_current & T_slotMask );
+            while( !slot.isEmpty() ) {
+                auto h= slot.frontHandle();
+                auto e= std::move( h->m_event );
+                if( h->m_period ) {
+                    park( h );
+                } else {
+                    removeFromSlot( h );
+                }
+
+                func( std::move( e ) );
+            }
+        }
+    }
+};
+
+
+#endif //PROMISE_TIMINGWHEEL_H
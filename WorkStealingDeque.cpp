@@ -0,0 +1,5 @@
+//
+// Created by Matthias Preymann on 06.10.2019.
+//
+
+#include "WorkStealingDeque.h"
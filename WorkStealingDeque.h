@@ -0,0 +1,180 @@
+//
+// Created by Matthias Preymann on 06.10.2019.
+//
+
+#ifndef PROMISE_WORKSTEALINGDEQUE_H
+#define PROMISE_WORKSTEALINGDEQUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "ObjectPool.h"
+#include "SmallStack.h"
+
+
+/**
+ * Templated Work Stealing Deque Class
+ * Chase-Lev deque of unique pointers to objects of type T_Element
+ * The owner thread pushes and pops at the bottom end without taking a lock,
+ * while any other thread may steal from the top end. Only when the owner
+ * and a thief go for the last element they race with a compare-and-swap
+ * on the top index
+ * The ring buffer grows in multiples of 2 when it is full. Retired buffers
+ * are kept until the deque is destroyed, as a thief might still read from
+ * the buffer it loaded before the owner replaced it
+ * Objects that are still stored are destroyed with the deque
+ *
+ * @tparam T_Element - Type of object to be referenced
+ */
+template< typename T_Element >
+class WorkStealingDeque {
+private:
+
+    /**
+     * Internal Ring Buffer Class
+     * The cells are atomic, as a thief might read a cell the owner
+     * is overwriting after the element was taken
+     */
+    class RingBuffer {
+    private:
+        const std::int64_t m_mask;
+        std::unique_ptr< std::atomic< T_Element* >[] > m_cells;
+
+    public:
+        explicit RingBuffer( const std::int64_t cap )
+                : m_mask( cap- 1 ), m_cells( new std::atomic< T_Element* >[ cap ] ) {}
+
+        inline std::int64_t capacity() const {
+            return m_mask+ 1;
+        }
+
+        inline T_Element* get( const std::int64_t i ) const {
+            return m_cells[ i & m_mask ].load( std::memory_order_relaxed );
+        }
+
+        inline void put( const std::int64_t i, T_Element* const e ) {
+            m_cells[ i & m_mask ].store( e, std::memory_order_relaxed );
+        }
+    };
+
+    std::atomic< std::int64_t > m_top;
+    std::atomic< std::int64_t > m_bottom;
+    std::atomic< RingBuffer* > m_buffer;
+
+    SmallStack< std::unique_ptr< RingBuffer > > m_buffers;
+
+    RingBuffer* grow( RingBuffer* const old, const std::int64_t top, const std::int64_t bottom ) {
+        auto buffer= new RingBuffer( 2* old->capacity() );
+        m_buffers.push( std::unique_ptr< RingBuffer >( buffer ) );
+
+        for( auto i= top; i!= bottom; i++ ) {
+            buffer->put( i, old->get( i ) );
+        }
+
+        m_buffer.store( buffer, std::memory_order_release );
+        return buffer;
+    }
+
+public:
+    static constexpr std::int64_t T_defaultCapacity= 64;
+
+    /**
+     * @param cap - Initial capacity: has to be a power of 2
+     */
+    explicit WorkStealingDeque( const std::int64_t cap= T_defaultCapacity )
+            : m_top( 0 ), m_bottom( 0 ) {
+        auto buffer= new RingBuffer( cap );
+        m_buffers.push( std::unique_ptr< RingBuffer >( buffer ) );
+        m_buffer.store( buffer, std::memory_order_relaxed );
+    }
+
+    WorkStealingDeque( const WorkStealingDeque& )= delete;
+
+    ~WorkStealingDeque() {
+        // Every popped element is destroyed right away
+        while( pop() ) {}
+    }
+
+    /**
+     * Can be called by any thread, but is only a hint while other threads
+     * modify the deque
+     */
+    inline bool isEmpty() const {
+        return m_bottom.load( std::memory_order_relaxed ) <= m_top.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * Only to be called by the owner thread
+     */
+    void push( PoolPointer< T_Element > p ) {
+        const auto bottom= m_bottom.load( std::memory_order_relaxed );
+        const auto top= m_top.load( std::memory_order_acquire );
+        auto buffer= m_buffer.load( std::memory_order_relaxed );
+
+        if( bottom- top >= buffer->capacity() ) {
+            buffer= grow( buffer, top, bottom );
+        }
+
+        buffer->put( bottom, p.release() );
+
+        // Publish the element with the new bottom
+        m_bottom.store( bottom+ 1, std::memory_order_release );
+    }
+
+    /**
+     * Take the most recently pushed element
+     * Only to be called by the owner thread
+     */
+    PoolPointer< T_Element > pop() {
+        const auto bottom= m_bottom.load( std::memory_order_relaxed )- 1;
+        auto buffer= m_buffer.load( std::memory_order_relaxed );
+
+        // Reserve the element before looking at the top, so a thief sees the reservation
+        m_bottom.store( bottom, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        auto top= m_top.load( std::memory_order_relaxed );
+
+        if( top > bottom ) {
+            // Empty
+            m_bottom.store( bottom+ 1, std::memory_order_release );
+            return nullptr;
+        }
+
+        auto e= buffer->get( bottom );
+        if( top == bottom ) {
+            // Last element, race the thieves for it
+            if( !m_top.compare_exchange_strong( top, top+ 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+                e= nullptr;
+            }
+            m_bottom.store( bottom+ 1, std::memory_order_release );
+        }
+
+        return PoolPointer< T_Element >( e );
+    }
+
+    /**
+     * Take the least recently pushed element
+     * Can be called by any thread, fails if the deque is empty or
+     * another thread took the element first
+     */
+    PoolPointer< T_Element > steal() {
+        auto top= m_top.load( std::memory_order_acquire );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        const auto bottom= m_bottom.load( std::memory_order_acquire );
+
+        if( top >= bottom ) {
+            return nullptr;
+        }
+
+        auto buffer= m_buffer.load( std::memory_order_acquire );
+        auto e= buffer->get( top );
+        if( !m_top.compare_exchange_strong( top, top+ 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+            return nullptr;
+        }
+
+        return PoolPointer< T_Element >( e );
+    }
+};
+
+
+#endif //PROMISE_WORKSTEALINGDEQUE_H
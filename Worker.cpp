@@ -3,27 +3,37 @@
 //
 
 #include "Worker.h"
-#include "EventQueue.h"
+#include "WorkerPool.h"
 #include "EventLoop.h"
 #include "Task.h"
 #include "Console.h"
 
-Worker::Worker(EventQueue<Task> &q, EventLoop& l, const unsigned int i)
-        : m_enable( true ), m_id(i), m_queue(q), m_eventLoop(l), m_thread(Worker::run, this) {}
+thread_local Worker* Worker::m_current= nullptr;
+
+Worker::Worker(WorkerPool &p, EventLoop& l, const unsigned int i, const WaitPolicy& w)
+        : m_enable( true ), m_id(i), m_priority( Priority::Normal ), m_localPops( 0 ), m_eventLoop(l), m_pool(p),
+          m_spinWait( w ), m_thread(Worker::run, this) {}
+
+Worker::~Worker()= default;
 
 void Worker::run()  {
+    m_current= this;
+
     while( m_enable ) {
         Console::println( "Worker ", m_id, " is waiting for work..." );
         WorkerInterface intf(this);
 
-        auto ev= m_queue.waitForPop();
+        auto ev= m_pool.nextTask( *this );
+        m_priority= ev->getPriority();
         ev->execute( intf );
     }
+
+    m_current= nullptr;
     Console::println( "Stopping worker ", m_id );
 }
 
 void Worker::sendEvent(PoolPointer<Event> ev) {
-    m_eventLoop.sendEvent( std::move(ev) );
+    m_eventLoop.sendEvent( std::move(ev), m_priority );
 }
 
 void Worker::WorkerInterface::sendEvent(PoolPointer<Event> ev) {
@@ -8,30 +8,44 @@
 #include <thread>
 #include <iostream>
 #include "ObjectPool.h"
+#include "WorkStealingDeque.h"
+#include "Priority.h"
+#include "SpinWait.h"
 
 class Task;
 
-template < typename T >
-class EventQueue;
-
 class EventLoop;
 class Event;
+class WorkerPool;
 
 /**
  * Worker Class
- * Thread that waits for messages from the event (task) queue
- * Received tasks are executed
+ * Thread that takes tasks from its worker pool and executes them
+ * Every worker has its own deque, which receives the tasks submitted while
+ * running on the worker thread, and which other workers may steal from
  */
 class Worker {
 private:
+    friend WorkerPool;
+
     bool m_enable;
     const unsigned int m_id;
 
+    // Priority of the task currently executed
+    Priority m_priority;
+
+    // Tasks taken from the own deque since the injector was last served
+    unsigned int m_localPops;
+
     EventLoop& m_eventLoop;
+    WorkerPool& m_pool;
 
-    EventQueue<Task>& m_queue;
+    WorkStealingDeque<Task> m_deque;
+    SpinWait m_spinWait;
     std::thread m_thread;
 
+    static thread_local Worker* m_current;
+
 
     inline void stop() {
         m_enable= false;
@@ -66,10 +80,26 @@ public:
 
     friend WorkerInterface;
 
-    Worker( EventQueue<Task>& q, EventLoop& l, const unsigned int i );
+    /**
+     * @param w - Wait policy of the worker, which is set before its thread starts
+     */
+    Worker( WorkerPool& p, EventLoop& l, const unsigned int i, const WaitPolicy& w= SpinWait::T_defaultPolicy );
 
     Worker( Worker& w ) = delete;
 
+    ~Worker();
+
+    /**
+     * Worker running on the calling thread, nullptr if it is not a worker thread
+     */
+    static inline Worker* current() {
+        return m_current;
+    }
+
+    inline WorkerPool& getPool() {
+        return m_pool;
+    }
+
     void join() {
         m_thread.join();
     }
@@ -5,7 +5,9 @@
 #include "WorkerPool.h"
 #include "Worker.h"
 
-WorkerPool::WorkerPool(EventLoop &l, unsigned int n)  {
+WorkerPool::WorkerPool(EventLoop &l, unsigned int n, std::size_t capacity, QueuePolicy policy)
+        : m_eventLoop( l ), m_injector( capacity, policy ), m_stealCount( 0 ), m_parked( 0 ), m_wakeUps( 0 ),
+          m_waitSpins( SpinWait::T_defaultPolicy.m_spins ), m_waitYields( SpinWait::T_defaultPolicy.m_yields ) {
     m_workers.reserve( n );
     for( ; n; n-- ) {
         spawnWorker( l );
@@ -13,16 +15,157 @@ WorkerPool::WorkerPool(EventLoop &l, unsigned int n)  {
 }
 
 void WorkerPool::stopAndJoin() {
-    m_queue.replace<StopTask>( heapAlloc, size() );
+    // Every worker takes exactly one stop task from the injector
+    m_injector.replace<StopTask>( heapAlloc, size() );
+
+    {
+        std::lock_guard<std::mutex> lock( m_parkMutex );
+        m_wakeUps= m_parked.load( std::memory_order_relaxed );
+        m_parkCvar.notify_all();
+    }
+
     for( auto& w : m_workers ) {
         w->join();
     }
 }
 
 void WorkerPool::spawnWorker(EventLoop &l)  {
-    m_workers.emplace_back( std::make_unique<Worker>( m_queue, l, size() ) );
+    // Other workers read the array while stealing, so it must not be reallocated
+    if( size() == m_workers.capacity() && m_stealCount.load( std::memory_order_relaxed ) ) {
+        throw std::runtime_error( "Cannot add workers beyond the initial count." );
+    }
+
+    // The policy has to be set before the thread of the worker starts
+    m_workers.emplace_back( std::make_unique<Worker>( *this, l, size(), getWaitPolicy() ) );
+    m_stealCount.store( size(), std::memory_order_release );
+}
+
+void WorkerPool::setWaitPolicy(const WaitPolicy &p) {
+    m_waitSpins.store( p.m_spins, std::memory_order_relaxed );
+    m_waitYields.store( p.m_yields, std::memory_order_relaxed );
+    for( auto& w : m_workers ) {
+        w->m_spinWait.setPolicy( p );
+    }
+}
+
+void WorkerPool::submitTask(PoolPointer<Task> e, Priority p) {
+    e->setPriority( p );
+
+    auto w= Worker::current();
+    if( w && &w->getPool() == this && p != Priority::Critical ) {
+        w->m_deque.push( std::move( e ) );
+
+    } else {
+        const auto task= e.get();
+        if( auto overflow= m_injector.push( std::move( e ), laneOf( p ) ) ) {
+            const bool queued= overflow.get() != task;
+            overflow->reject( m_eventLoop );
+
+            if( !queued ) {
+                return;
+            }
+        }
+    }
+
+    notifyParked();
+}
+
+PoolPointer<Task> WorkerPool::findTask( Worker& w, bool& spilled ) {
+    if( m_injector.getDepth( laneOf( Priority::Critical ) ) ) {
+        if( auto t= m_injector.popLane( laneOf( Priority::Critical ) ) ) {
+            return t;
+        }
+    }
+
+    // Serve the injector every now and then, even if the own deque is not empty
+    if( w.m_localPops >= T_localPopLimit ) {
+        w.m_localPops= 0;
+        if( m_injector.getDepth() ) {
+            if( auto t= m_injector.pop() ) {
+                return t;
+            }
+        }
+    }
+
+    if( auto t= w.m_deque.pop() ) {
+        w.m_localPops++;
+        return t;
+    }
+
+    w.m_localPops= 0;
+
+    // Take a batch from the injector under a single lock and keep the rest in the
+    // own deque, where idle workers can steal them. Spinning workers only take the
+    // lock if the injector holds anything
+    PoolPointer<Task> batch[ T_injectorBatchSize ];
+    std::size_t num;
+    if( m_injector.getDepth() && (num= m_injector.popN( batch, T_injectorBatchSize )) ) {
+        for( auto i= num- 1; i; i-- ) {
+            w.m_deque.push( std::move( batch[i] ) );
+        }
+
+        spilled= num > 1;
+        return std::move( batch[0] );
+    }
+
+    // Try the other workers in turn, starting at the next one
+    const auto count= m_stealCount.load( std::memory_order_acquire );
+    for( std::size_t i= 1; i< count; i++ ) {
+        auto& victim= m_workers[ (w.m_id+ i) % count ]->m_deque;
+
+        // Stealing fails if another thread is faster, so retry as long as there is something left
+        while( !victim.isEmpty() ) {
+            if( auto t= victim.steal() ) {
+                return t;
+            }
+        }
+    }
+
+    return nullptr;
 }
 
-void WorkerPool::submitTask(PoolPointer<Task> e) {
-    m_queue.push( std::move( e ) );
-}
\ No newline at end of file
+PoolPointer<Task> WorkerPool::nextTask( Worker& w ) {
+    while( true ) {
+        PoolPointer<Task> t;
+        bool spilled= false;
+        if( w.m_spinWait.wait( [&]() { return (t= findTask( w, spilled )) != nullptr; } ) ) {
+            if( spilled ) {
+                notifyParked();
+            }
+            return t;
+        }
+
+        std::unique_lock<std::mutex> lock( m_parkMutex );
+        m_parked.fetch_add( 1, std::memory_order_relaxed );
+
+        // Pairs with the fence in 'notifyParked', so either the task is found or the worker is woken up
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( (t= findTask( w, spilled )) ) {
+            m_parked.fetch_sub( 1, std::memory_order_relaxed );
+
+            // Waking up others needs the park mutex, which is not recursive
+            lock.unlock();
+            if( spilled ) {
+                notifyParked();
+            }
+            return t;
+        }
+
+        m_parkCvar.wait( lock, [this]() { return m_wakeUps > 0; } );
+        m_wakeUps--;
+        m_parked.fetch_sub( 1, std::memory_order_relaxed );
+    }
+}
+
+void WorkerPool::notifyParked() {
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( !m_parked.load( std::memory_order_relaxed ) ) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( m_parkMutex );
+    if( m_wakeUps < m_parked.load( std::memory_order_relaxed ) ) {
+        m_wakeUps++;
+        m_parkCvar.notify_one();
+    }
+}
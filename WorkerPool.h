@@ -5,31 +5,100 @@
 #ifndef PROMISE_WORKERPOOL_H
 #define PROMISE_WORKERPOOL_H
 
+#include <atomic>
 #include "EventQueue.h"
 #include "Task.h"
 class EventLoop;
 
 /**
  * Worker Pool Class
- * Holds an array of worker threads and the event (task) queue
+ * Holds an array of worker threads and schedules the tasks between them
+ * Tasks submitted by a worker go to its own deque, all others are put into
+ * the shared injector queue. A worker runs its own tasks first, then takes
+ * a batch from the injector and finally tries to steal from the other workers
+ * After a number of tasks from its own deque a worker takes one task from the
+ * injector through the lane scheduler, so workers that keep submitting subtasks
+ * cannot starve the tasks of other threads
+ * Workers without any work keep looking for a while according to the wait
+ * policy, before they park. They are only woken up if there are parked workers
+ * when a task is submitted
+ * The injector can be bounded. Tasks that overflow it according to the queue
+ * policy are rejected on the submitting thread
+ * Every priority has its own lane in the injector. Critical tasks always go to
+ * the injector, so any idle worker can pick them up, and workers look there
+ * for them before taking from their own deque
  */
 class WorkerPool {
 private:
-    EventQueue<Task> m_queue;
-    std::vector<std::unique_ptr<Worker>> m_workers;
+    static constexpr std::size_t T_injectorBatchSize= 8;
+    static constexpr unsigned int T_localPopLimit= 32;
+
+    EventLoop& m_eventLoop;
+    EventQueue<Task, T_priorityCount> m_injector;
+    std::vector<std::unique_ptr<Worker>, PoolStdAllocator<std::unique_ptr<Worker>>> m_workers;
+
+    // Number of workers that can be stolen from, the array may not grow while they are stolen from
+    std::atomic<std::size_t> m_stealCount;
+
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCvar;
+    std::atomic<unsigned int> m_parked;
+    unsigned int m_wakeUps;
+
+    // Policy for new workers, read and written while the workers run
+    std::atomic<unsigned int> m_waitSpins;
+    std::atomic<unsigned int> m_waitYields;
+
+    /**
+     * @param spilled - Set if tasks of the injector were moved to the own deque, so the
+     *                  caller has to wake up parked workers once it holds no lock
+     */
+    PoolPointer<Task> findTask( Worker& w, bool& spilled );
+
+    void notifyParked();
 
 public:
-    WorkerPool( EventLoop& l, unsigned int n );
+    /**
+     * @param capacity - Max number of tasks waiting in the injector: zero for no limit
+     * @param policy - Behaviour when a task is submitted while the injector is full
+     */
+    WorkerPool( EventLoop& l, unsigned int n, std::size_t capacity= 0, QueuePolicy policy= QueuePolicy::Block );
 
     inline std::size_t size() const {
         return m_workers.size();
     }
 
+    /**
+     * Number of tasks waiting in the injector
+     */
+    inline std::size_t getQueueDepth() const {
+        return m_injector.getDepth();
+    }
+
+    inline std::size_t getQueueDepth( const Priority p ) const {
+        return m_injector.getDepth( laneOf( p ) );
+    }
+
+    /**
+     * Can be changed while the workers run, as they only read their policy atomically
+     */
+    void setWaitPolicy( const WaitPolicy& p );
+
+    inline WaitPolicy getWaitPolicy() const {
+        return WaitPolicy{ m_waitSpins.load( std::memory_order_relaxed ), m_waitYields.load( std::memory_order_relaxed ) };
+    }
+
     void spawnWorker( EventLoop& l );
 
     void stopAndJoin();
 
-    void submitTask(PoolPointer<Task> e);
+    void submitTask(PoolPointer<Task> e, Priority p= Priority::Normal);
+
+    /**
+     * Block until there is a task for the worker
+     * Only to be called by the worker thread
+     */
+    PoolPointer<Task> nextTask( Worker& w );
 };
 
 
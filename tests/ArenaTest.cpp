@@ -0,0 +1,132 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <cassert>
+#include <iostream>
+#include "../Arena.h"
+
+static int destructed= 0;
+
+struct Counted {
+    int m_value;
+
+    explicit Counted( const int v )
+            : m_value( v ) {}
+
+    ~Counted() {
+        destructed++;
+    }
+};
+
+static void testResetDestroysObjects() {
+    destructed= 0;
+    Arena a( 1024 );
+
+    for( int i= 0; i!= 100; i++ ) {
+        a.create<Counted>( i );
+    }
+
+    // Larger than a chunk
+    a.allocate( 4096 );
+
+    assert( a.reset() );
+    assert( destructed == 100 );
+
+    // Nothing is left to destroy
+    assert( a.reset() );
+    assert( destructed == 100 );
+}
+
+static void testContainers() {
+    Arena a( 1024 );
+    using T_String= std::basic_string< char, std::char_traits<char>, ArenaAllocator<char> >;
+
+    std::vector< int, ArenaAllocator<int> > v{ ArenaAllocator<int>( a ) };
+    for( int i= 0; i!= 5000; i++ ) {
+        v.push_back( i );
+    }
+
+    T_String s( "A string that is too long for the small string buffer", ArenaAllocator<char>( a ) );
+    assert( v[4999] == 4999 );
+    assert( s.size() > 40 );
+
+    struct alignas(128) Aligned { char m_data[8]; };
+    auto p= a.create<Aligned>();
+    assert( reinterpret_cast<std::uintptr_t>( p ) % 128 == 0 );
+}
+
+static void testPinKeepsOlderObjects() {
+    destructed= 0;
+    Arena a( 1024 );
+
+    auto kept= a.create<Counted>( 42 );
+    auto pin= a.pin();
+
+    for( int round= 0; round!= 50; round++ ) {
+        for( int i= 0; i!= 20; i++ ) {
+            a.create<Counted>( i );
+        }
+        a.allocate( 4096 );
+
+        // Only the objects above the pin are destroyed, and their memory is reused
+        assert( !a.reset() );
+        assert( kept->m_value == 42 );
+    }
+    assert( destructed == 1000 );
+
+    pin.release();
+    assert( a.reset() );
+    assert( destructed == 1001 );
+}
+
+static void testOverlappingPins() {
+    destructed= 0;
+    Arena a( 256 );
+
+    auto first= a.create<Counted>( 1 );
+    auto pinA= a.pin();
+    auto second= a.create<Counted>( 2 );
+    auto pinB= a.pin();
+    a.create<Counted>( 3 );
+
+    // Everything below the newest pin survives
+    assert( !a.reset() );
+    assert( destructed == 1 );
+    assert( first->m_value == 1 && second->m_value == 2 );
+
+    // Overwrite the memory above the pins
+    for( int i= 0; i!= 100; i++ ) {
+        a.create<Counted>( -1 );
+    }
+    assert( !a.reset() );
+    assert( destructed == 101 );
+    assert( first->m_value == 1 && second->m_value == 2 );
+
+    // Releasing the older pin first must not touch what the newer one keeps
+    pinA.release();
+    assert( !a.reset() );
+    assert( destructed == 101 );
+    assert( second->m_value == 2 );
+
+    // Pins may be released by other threads
+    std::thread t( [p= std::move( pinB )]() mutable { p.release(); } );
+    t.join();
+
+    assert( a.reset() );
+    assert( destructed == 103 );
+    assert( !a.isPinned() );
+}
+
+int main() {
+    testResetDestroysObjects();
+    testContainers();
+    testPinKeepsOlderObjects();
+    testOverlappingPins();
+
+    std::cout << "ArenaTest passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cassert>
+#include <iostream>
+#include "../CachedObjectPool.h"
+
+using T_Pool= CachedObjectPool< long >;
+
+static void testThreadExitReturnsCells() {
+    T_Pool pool( 100 );
+
+    std::thread t( [&pool]() {
+        long* objects[ 50 ];
+        for( auto& o : objects ) {
+            o= pool.create<long>( 1 );
+        }
+
+        // The cells end up in the magazine of this thread
+        for( auto o : objects ) {
+            pool.free( o );
+        }
+        assert( pool.usage() > 0 );
+    });
+    t.join();
+
+    assert( pool.usage() == 0 );
+}
+
+static void testFlushThreadCache() {
+    T_Pool pool( 100 );
+
+    pool.free( pool.create<long>( 1 ) );
+    assert( pool.usage() > 0 );
+
+    pool.flushThreadCache();
+    assert( pool.usage() == 0 );
+}
+
+static void testPoolDestroyedBeforeThread() {
+    std::mutex mutex;
+    std::condition_variable cvar;
+    int step= 0;
+
+    auto pool= std::make_unique<T_Pool>( 100 );
+
+    std::thread t( [&]() {
+        pool->free( pool->create<long>( 1 ) );
+
+        std::unique_lock<std::mutex> lock( mutex );
+        step= 1;
+        cvar.notify_one();
+        cvar.wait( lock, [&]() { return step == 2; } );
+        lock.unlock();
+
+        // The magazine of the destroyed pool is dropped when a new one is created
+        T_Pool other( 100 );
+        other.free( other.create<long>( 2 ) );
+    });
+
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        cvar.wait( lock, [&]() { return step == 1; } );
+
+        // The thread still caches a cell of the pool
+        pool.reset();
+        step= 2;
+        cvar.notify_one();
+    }
+
+    t.join();
+}
+
+int main() {
+    testThreadExitReturnsCells();
+    testFlushThreadCache();
+    testPoolDestroyedBeforeThread();
+
+    std::cout << "CachedObjectPoolTest passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include "../LockFreeObjectPool.h"
+
+struct Stamp {
+    long m_owner;
+    long m_value;
+
+    Stamp( const long o, const long v )
+            : m_owner( o ), m_value( v ) {}
+};
+
+using T_Pool= LockFreeObjectPool< Stamp >;
+
+static void testGrowAndReuse() {
+    T_Pool pool( 10 );
+    assert( pool.space() == 10 );
+
+    Stamp* objects[ 11 ];
+    for( long i= 0; i!= 10; i++ ) {
+        objects[i]= pool.create<Stamp>( 0, i );
+    }
+    assert( pool.space() == 0 );
+
+    // Adds a block
+    objects[10]= pool.create<Stamp>( 0, 10 );
+    assert( pool.space() == 9 );
+
+    pool.freeN( objects, 11 );
+    assert( pool.space() == 20 );
+
+    // Freed cells are reused before another block is added
+    pool.createN( objects, 11, 1l, 2l );
+    assert( pool.space() == 9 );
+    assert( objects[5]->m_owner == 1 && objects[5]->m_value == 2 );
+    pool.freeN( objects, 11 );
+}
+
+static void testConcurrentUse() {
+    constexpr long threadCount= 4;
+    constexpr long rounds= 20000;
+    constexpr std::size_t held= 16;
+
+    T_Pool pool( 8 );
+
+    std::vector<std::thread> threads;
+    for( long t= 0; t!= threadCount; t++ ) {
+        threads.emplace_back( [&pool, t]() {
+            Stamp* objects[ held ];
+
+            for( long r= 0; r!= rounds; r++ ) {
+                // Alternate between single and batch operations
+                const auto num= 1+ static_cast<std::size_t>( r % held );
+                if( r & 1 ) {
+                    pool.createN( objects, num, t, r );
+
+                } else {
+                    for( std::size_t i= 0; i!= num; i++ ) {
+                        objects[i]= pool.create<Stamp>( t, r );
+                    }
+                }
+
+                if( !(r % 64) ) {
+                    std::this_thread::yield();
+                }
+
+                // A cell handed out twice would be overwritten by another thread
+                for( std::size_t i= 0; i!= num; i++ ) {
+                    assert( objects[i]->m_owner == t && objects[i]->m_value == r );
+                }
+
+                if( r & 2 ) {
+                    pool.freeN( objects, num );
+
+                } else {
+                    for( std::size_t i= 0; i!= num; i++ ) {
+                        pool.free( objects[i] );
+                    }
+                }
+            }
+        });
+    }
+
+    for( auto& t : threads ) {
+        t.join();
+    }
+
+    // Every cell is back on the stack and counted
+    const auto space= pool.space();
+    std::vector< Stamp* > objects( space );
+    pool.createN( objects.data(), space, 0l, 0l );
+    assert( pool.space() == 0 );
+    pool.freeN( objects.data(), space );
+    assert( pool.space() == space );
+}
+
+int main() {
+    testGrowAndReuse();
+    testConcurrentUse();
+
+    std::cout << "LockFreeObjectPoolTest passed" << std::endl;
+    return 0;
+}
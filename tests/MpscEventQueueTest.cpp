@@ -0,0 +1,122 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include "../MpscEventQueue.h"
+
+static std::atomic<int> destructed{ 0 };
+
+struct Item : public PooledObject, public MpscQueueLink {
+    const int m_producer;
+    const long m_value;
+
+    Item( Deallocator* d, const int p, const long v )
+            : PooledObject( d ), m_producer( p ), m_value( v ) {}
+
+    ~Item() {
+        destructed++;
+    }
+};
+
+static void testBatches() {
+    MpscEventQueue<Item> queue;
+    assert( !queue.pop() );
+
+    PoolPointer<Item> items[5];
+    for( long i= 0; i!= 5; i++ ) {
+        items[i]= heapAlloc.allocate<Item>( 0, i );
+    }
+    queue.pushN( items, 5 );
+    assert( queue.getDepth() == 5 );
+
+    PoolPointer<Item> out[3];
+    assert( queue.waitForPopN( out, 3 ) == 3 );
+    assert( out[0]->m_value == 0 && out[2]->m_value == 2 );
+    assert( queue.popN( out, 3 ) == 2 );
+    assert( out[1]->m_value == 4 );
+    assert( !queue.popN( out, 3 ) );
+    assert( !queue.getDepth() );
+}
+
+static void testTimedWait() {
+    MpscEventQueue<Item> queue;
+
+    const auto start= std::chrono::steady_clock::now();
+    assert( !queue.waitForPopUntil( start+ std::chrono::milliseconds( 5 ) ) );
+    assert( std::chrono::steady_clock::now() >= start+ std::chrono::milliseconds( 5 ) );
+
+    queue.push( heapAlloc.allocate<Item>( 0, 1 ) );
+    assert( queue.waitForPopUntil( std::chrono::steady_clock::now()+ std::chrono::milliseconds( 5 ) ) );
+}
+
+static void testDestroysRemaining() {
+    destructed= 0;
+    {
+        MpscEventQueue<Item> queue;
+        for( long i= 0; i!= 10; i++ ) {
+            queue.push( heapAlloc.allocate<Item>( 0, i ) );
+        }
+    }
+
+    assert( destructed == 10 );
+}
+
+static void testProducerOrder() {
+    constexpr int producerCount= 4;
+    constexpr long count= 100000;
+
+    MpscEventQueue<Item> queue;
+
+    std::vector<std::thread> producers;
+    for( int p= 0; p!= producerCount; p++ ) {
+        producers.emplace_back( [&queue, p]() {
+            for( long i= 0; i!= count; ) {
+                // Mix single pushes and batches
+                if( !(i % 7) && i+ 3 <= count ) {
+                    PoolPointer<Item> items[3];
+                    for( long k= 0; k!= 3; k++ ) {
+                        items[k]= heapAlloc.allocate<Item>( p, i+ k );
+                    }
+                    queue.pushN( items, 3 );
+                    i+= 3;
+
+                } else {
+                    queue.push( heapAlloc.allocate<Item>( p, i ) );
+                    i++;
+                }
+            }
+        });
+    }
+
+    // The elements of each producer arrive in the order they were pushed
+    long last[ producerCount ];
+    std::fill( last, last+ producerCount, -1 );
+    for( long received= 0; received != producerCount* count; received++ ) {
+        auto e= queue.waitForPop();
+        assert( e->m_value == last[ e->m_producer ]+ 1 );
+        last[ e->m_producer ]= e->m_value;
+    }
+
+    for( auto& t : producers ) {
+        t.join();
+    }
+
+    assert( !queue.pop() );
+}
+
+int main() {
+    testBatches();
+    testTimedWait();
+    testDestroysRemaining();
+    testProducerOrder();
+
+    std::cout << "MpscEventQueueTest passed" << std::endl;
+    return 0;
+}
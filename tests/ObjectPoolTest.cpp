@@ -0,0 +1,162 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <random>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include "../ObjectPool.h"
+
+struct Item {
+    long m_value;
+    char m_padding[24];
+
+    explicit Item( const long v )
+            : m_value( v ) {}
+};
+
+static void checkCounts( ObjectPool<Item>& pool, const std::size_t live ) {
+    assert( pool.usage() == live );
+    assert( pool.usage()+ pool.space() == pool.capacity() );
+}
+
+static void testTrimReleasesEmptyBlocks() {
+    ObjectPool<Item> pool( 100 );
+
+    std::vector< Item* > items;
+    for( long i= 0; i!= 1000; i++ ) {
+        items.push_back( pool.create<Item>( i ) );
+    }
+    assert( pool.capacity() == 1000 );
+    checkCounts( pool, 1000 );
+
+    // Cells are handed out in order, so the first half fills the first five blocks
+    for( std::size_t i= 0; i!= 500; i++ ) {
+        pool.free( items[i] );
+    }
+
+    assert( pool.trim() == 5 );
+    assert( pool.capacity() == 500 );
+    checkCounts( pool, 500 );
+
+    // Nothing left to release
+    assert( pool.trim() == 0 );
+
+    for( std::size_t i= 500; i!= 1000; i++ ) {
+        assert( items[i]->m_value == static_cast<long>( i ) );
+    }
+
+    // A single live cell keeps its block
+    for( std::size_t i= 500; i!= 1000; i++ ) {
+        if( i % 100 ) {
+            pool.free( items[i] );
+        }
+    }
+    assert( pool.trim() == 0 );
+    checkCounts( pool, 5 );
+
+    // At least one block is kept
+    for( std::size_t i= 500; i!= 1000; i+= 100 ) {
+        pool.free( items[i] );
+    }
+    assert( pool.trim() == 4 );
+    assert( pool.capacity() == 100 );
+    checkCounts( pool, 0 );
+}
+
+static void testPartialBlocksAreFilledFirst() {
+    ObjectPool<Item> pool( 10 );
+
+    std::vector< Item* > items;
+    for( long i= 0; i!= 40; i++ ) {
+        items.push_back( pool.create<Item>( i ) );
+    }
+
+    // Empty one block completely and leave holes in the others
+    for( std::size_t i= 0; i!= 10; i++ ) {
+        pool.free( items[i] );
+    }
+    for( std::size_t i= 10; i!= 40; i+= 2 ) {
+        pool.free( items[i] );
+    }
+
+    // Filling the holes must not touch the empty block
+    for( long i= 0; i!= 15; i++ ) {
+        pool.create<Item>( i );
+    }
+    assert( pool.capacity() == 40 );
+    assert( pool.trim() == 1 );
+    checkCounts( pool, 30 );
+}
+
+static void testAutoTrim() {
+    ObjectPool<Item> pool( 100 );
+    pool.setAutoTrim( 0.5f, 10 );
+
+    std::vector< Item* > items;
+    for( long i= 0; i!= 1000; i++ ) {
+        items.push_back( pool.create<Item>( i ) );
+    }
+
+    // The watermark follows the capacity, so the pool shrinks in steps
+    for( std::size_t i= 0; i!= 900; i++ ) {
+        pool.free( items[i] );
+    }
+
+    assert( pool.capacity() == 200 );
+    checkCounts( pool, 100 );
+
+    for( std::size_t i= 900; i!= 1000; i++ ) {
+        assert( items[i]->m_value == static_cast<long>( i ) );
+        pool.free( items[i] );
+    }
+
+    // The last block is kept
+    assert( pool.capacity() == 100 );
+    checkCounts( pool, 0 );
+}
+
+static void testRandomUsage() {
+    ObjectPool<Item> pool( 16 );
+    pool.setAutoTrim( 0.25f, 32 );
+
+    std::mt19937 rng( 42 );
+    std::vector< Item* > items;
+    long next= 0;
+
+    for( int round= 0; round!= 100000; round++ ) {
+        // Grow and shrink in waves
+        const bool grow= (round / 5000) % 2 == 0;
+        if( items.empty() || rng() % 4 < (grow ? 3u : 1u) ) {
+            items.push_back( pool.create<Item>( next++ ) );
+
+        } else {
+            const auto i= rng() % items.size();
+            std::swap( items[i], items.back() );
+            pool.free( items.back() );
+            items.pop_back();
+        }
+    }
+
+    checkCounts( pool, items.size() );
+
+    std::vector< bool > seen( next, false );
+    for( auto item : items ) {
+        assert( !seen[ item->m_value ] );
+        seen[ item->m_value ]= true;
+        pool.free( item );
+    }
+
+    checkCounts( pool, 0 );
+}
+
+int main() {
+    testTrimReleasesEmptyBlocks();
+    testPartialBlocksAreFilledFirst();
+    testAutoTrim();
+    testRandomUsage();
+
+    std::cout << "ObjectPoolTest passed" << std::endl;
+    return 0;
+}
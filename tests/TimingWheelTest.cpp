@@ -0,0 +1,247 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <random>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include "../TimingWheel.h"
+
+using namespace std::chrono;
+
+static int liveEvents= 0;
+
+class TestEvent : public Event {
+public:
+    const std::size_t m_index;
+
+    explicit TestEvent( const std::size_t i= 0 )
+            : Event( nullptr ), m_index( i ) {
+        liveEvents++;
+    }
+
+    ~TestEvent() override {
+        liveEvents--;
+    }
+
+    void execute( EventLoop& ) override {}
+};
+
+static inline std::size_t indexOf( const PoolPointer<Event>& e ) {
+    return static_cast<TestEvent*>( e.get() )->m_index;
+}
+
+static void testExpiryOrder() {
+    const auto start= TimingWheel::T_Clock::now();
+    TimingWheel wheel( milliseconds( 1 ), start );
+
+    std::mt19937_64 random( 7 );
+    std::vector< TimingWheel::T_TimePoint > deadlines;
+    std::vector< bool > expired;
+
+    auto now= start;
+    for( int round= 0; round!= 400; round++ ) {
+        // Mostly near deadlines, some far beyond the lowest levels
+        const auto count= random() % 50;
+        for( std::size_t i= 0; i!= count; i++ ) {
+            const auto offset= (random() % 4) ? microseconds( random() % 200000 )
+                                              : microseconds( random() % (10ull* 3600* 1000000) );
+            deadlines.push_back( now+ offset );
+            expired.push_back( false );
+            wheel.add( now+ offset, PoolPointer<Event>( new TestEvent( deadlines.size()- 1 ) ) );
+        }
+
+        const auto next= now+ milliseconds( random() % 5000 )+ ((round % 50) ? hours( 0 ) : hours( 1 ));
+
+        // Events expire in order of their deadlines, at most a tick apart
+        auto last= start;
+        wheel.advance( next, [&]( PoolPointer<Event> e ) {
+            const auto i= indexOf( e );
+            assert( !expired[i] );
+            assert( deadlines[i] <= next );
+            assert( deadlines[i]+ milliseconds( 1 ) > last );
+
+            last= deadlines[i];
+            expired[i]= true;
+        });
+        now= next;
+
+        // Nothing that is due is left behind
+        for( std::size_t i= 0; i!= deadlines.size(); i++ ) {
+            assert( expired[i] || deadlines[i]+ milliseconds( 1 ) > now );
+        }
+    }
+
+    wheel.advance( now+ hours( 20 ), [&]( PoolPointer<Event> e ) {
+        expired[ indexOf( e ) ]= true;
+    });
+
+    for( auto e : expired ) {
+        assert( e );
+    }
+    assert( wheel.isEmpty() );
+    assert( !liveEvents );
+}
+
+static void testCascading() {
+    const auto start= TimingWheel::T_Clock::now();
+    TimingWheel wheel( milliseconds( 1 ), start );
+
+    // Beyond the range of the lowest three levels
+    const auto deadline= start+ hours( 2 )+ milliseconds( 5 );
+    wheel.add( deadline, PoolPointer<Event>( new TestEvent() ) );
+
+    // Following the next deadline moves the event down level by level
+    int wakeUps= 0;
+    bool expired= false;
+    while( !expired ) {
+        const auto next= wheel.nextDeadline();
+        assert( next <= deadline+ milliseconds( 1 ) );
+
+        wheel.advance( next, [&]( PoolPointer<Event> ) {
+            expired= true;
+        });
+
+        wakeUps++;
+        assert( expired == (next >= deadline) );
+    }
+
+    // About one step per level instead of one per tick
+    assert( wakeUps <= 8 );
+    assert( wheel.isEmpty() );
+    assert( wheel.nextDeadline() == TimingWheel::T_TimePoint::max() );
+}
+
+static void testCancelAndReschedule() {
+    const auto start= TimingWheel::T_Clock::now();
+    TimingWheel wheel( milliseconds( 1 ), start );
+
+    std::vector< TimingWheel::Handle > handles;
+    for( int i= 0; i!= 1000; i++ ) {
+        handles.push_back( wheel.add( start+ milliseconds( i* 37 ), PoolPointer<Event>( new TestEvent( i ) ) ) );
+    }
+
+    // Cancelled events are destroyed right away
+    for( int i= 0; i< 1000; i+= 2 ) {
+        assert( wheel.cancel( handles[i] ) );
+    }
+    assert( liveEvents == 500 );
+    assert( wheel.getLength() == 500 );
+    assert( !wheel.cancel( handles[0] ) );
+
+    assert( wheel.reschedule( handles[999], start+ milliseconds( 1 ) ) );
+
+    int count= 0;
+    wheel.advance( start+ milliseconds( 2 ), [&]( PoolPointer<Event> e ) {
+        assert( indexOf( e ) == 999 );
+        count++;
+    });
+    assert( count == 1 );
+
+    // The handle of an expired event stays invalid, even if its record is reused
+    assert( !wheel.reschedule( handles[999], start+ milliseconds( 10 ) ) );
+    auto h= wheel.add( start+ milliseconds( 5 ), PoolPointer<Event>( new TestEvent() ) );
+    assert( !wheel.cancel( handles[999] ) );
+    assert( wheel.cancel( h ) );
+
+    wheel.advance( start+ hours( 1 ), [&]( PoolPointer<Event> e ) {
+        assert( indexOf( e ) % 2 );
+        count++;
+    });
+    assert( count == 500 );
+    assert( !liveEvents );
+    assert( wheel.isEmpty() );
+}
+
+static void testRepeating() {
+    const auto start= TimingWheel::T_Clock::now();
+    TimingWheel wheel( milliseconds( 1 ), start );
+
+    auto h= wheel.add( start+ milliseconds( 10 ), PoolPointer<Event>( new TestEvent() ), milliseconds( 10 ) );
+
+    std::vector< PoolPointer<Event> > expired;
+    auto collect= [&]( PoolPointer<Event> e ) {
+        expired.push_back( std::move( e ) );
+    };
+
+    wheel.advance( start+ milliseconds( 10 ), collect );
+    assert( expired.size() == 1 );
+    assert( wheel.isEmpty() );
+
+    // The same event object is put back
+    assert( wheel.rearm( h, expired[0] ) );
+    assert( !expired[0] );
+    expired.clear();
+
+    // Periods that were missed entirely are skipped
+    wheel.advance( start+ milliseconds( 55 ), collect );
+    assert( expired.size() == 1 );
+    assert( wheel.rearm( h, expired[0] ) );
+    expired.clear();
+    assert( wheel.nextDeadline() == start+ milliseconds( 60 ) );
+
+    assert( wheel.cancel( h ) );
+    assert( !liveEvents );
+
+    // Cancelling while the event is out of the wheel leaves it with the caller
+    h= wheel.add( start+ milliseconds( 70 ), PoolPointer<Event>( new TestEvent() ), milliseconds( 10 ) );
+    wheel.advance( start+ milliseconds( 70 ), collect );
+    assert( wheel.cancel( h ) );
+    assert( !wheel.rearm( h, expired[0] ) );
+    assert( expired[0] );
+
+    expired.clear();
+    assert( !liveEvents );
+}
+
+static void testSlack() {
+    const auto start= TimingWheel::T_Clock::now();
+    TimingWheel wheel( milliseconds( 1 ), start );
+
+    const auto slack= milliseconds( 200 );
+    std::vector< TimingWheel::T_TimePoint > deadlines;
+    for( int i= 0; i!= 100; i++ ) {
+        deadlines.push_back( start+ milliseconds( 1000+ i ) );
+        wheel.add( deadlines.back(), PoolPointer<Event>( new TestEvent( i ) ), TimingWheel::T_Duration::zero(), slack );
+    }
+
+    // Without slack the event expires at its deadline
+    const auto exactDeadline= start+ milliseconds( 1050 );
+    wheel.add( exactDeadline, PoolPointer<Event>( new TestEvent( 100 ) ) );
+
+    // Nearby expiries are coalesced, but never leave their window
+    int wakeUps= 0;
+    int count= 0;
+    while( !wheel.isEmpty() ) {
+        const auto now= wheel.nextDeadline();
+        wakeUps++;
+
+        wheel.advance( now, [&]( PoolPointer<Event> e ) {
+            const auto i= indexOf( e );
+            if( i == 100 ) {
+                assert( now == exactDeadline );
+
+            } else {
+                assert( now >= deadlines[i] );
+                assert( now <= deadlines[i]+ slack+ milliseconds( 1 ) );
+            }
+
+            count++;
+        });
+    }
+
+    assert( count == 101 );
+    assert( wakeUps < 10 );
+}
+
+int main() {
+    testExpiryOrder();
+    testCascading();
+    testCancelAndReschedule();
+    testRepeating();
+    testSlack();
+
+    std::cout << "TimingWheelTest passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include "../WorkStealingDeque.h"
+
+static std::atomic<int> destructed{ 0 };
+
+struct Item : public PooledObject {
+    const long m_value;
+
+    Item( Deallocator* d, const long v )
+            : PooledObject( d ), m_value( v ) {}
+
+    ~Item() {
+        destructed++;
+    }
+};
+
+static void testOrder() {
+    WorkStealingDeque<Item> deque( 2 );
+    assert( deque.isEmpty() );
+    assert( !deque.pop() );
+    assert( !deque.steal() );
+
+    // Grows beyond the initial capacity
+    for( long i= 0; i!= 10; i++ ) {
+        deque.push( heapAlloc.allocate<Item>( i ) );
+    }
+
+    // The owner takes the newest element, thieves the oldest one
+    assert( deque.pop()->m_value == 9 );
+    assert( deque.steal()->m_value == 0 );
+    assert( deque.steal()->m_value == 1 );
+    assert( deque.pop()->m_value == 8 );
+
+    for( long i= 7; i!= 1; i-- ) {
+        assert( deque.pop()->m_value == i );
+    }
+
+    assert( deque.isEmpty() );
+    assert( !deque.pop() );
+}
+
+static void testDestroysRemaining() {
+    destructed= 0;
+    {
+        WorkStealingDeque<Item> deque( 4 );
+        for( long i= 0; i!= 10; i++ ) {
+            deque.push( heapAlloc.allocate<Item>( i ) );
+        }
+    }
+
+    assert( destructed == 10 );
+}
+
+static void testConcurrentSteal() {
+    constexpr long count= 200000;
+    constexpr int thiefCount= 3;
+
+    WorkStealingDeque<Item> deque( 4 );
+    std::atomic<bool> stop{ false };
+    std::atomic<long> sum{ 0 };
+    std::atomic<long> taken{ 0 };
+
+    std::vector<std::thread> thieves;
+    for( int i= 0; i!= thiefCount; i++ ) {
+        thieves.emplace_back( [&]() {
+            while( !stop ) {
+                if( auto e= deque.steal() ) {
+                    sum+= e->m_value;
+                    taken++;
+                }
+            }
+        });
+    }
+
+    // The owner pops every few pushes, so it races the thieves for the last elements
+    long expected= 0;
+    for( long i= 1; i<= count; i++ ) {
+        deque.push( heapAlloc.allocate<Item>( i ) );
+        expected+= i;
+
+        if( !(i % 3) ) {
+            if( auto e= deque.pop() ) {
+                sum+= e->m_value;
+                taken++;
+            }
+        }
+    }
+
+    while( auto e= deque.pop() ) {
+        sum+= e->m_value;
+        taken++;
+    }
+
+    // Thieves might still hold the last elements
+    while( taken != count ) {
+        std::this_thread::yield();
+    }
+
+    stop= true;
+    for( auto& t : thieves ) {
+        t.join();
+    }
+
+    // Every element was taken exactly once
+    assert( sum == expected );
+    assert( deque.isEmpty() );
+}
+
+int main() {
+    testOrder();
+    testDestroysRemaining();
+    testConcurrentSteal();
+
+    std::cout << "WorkStealingDequeTest passed" << std::endl;
+    return 0;
+}
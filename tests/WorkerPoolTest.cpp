@@ -0,0 +1,73 @@
+//
+// Created by Matthias Preymann on 12.10.2019.
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cassert>
+#include <iostream>
+#include "../WorkerPool.h"
+#include "../EventLoop.h"
+#include "../Worker.h"
+#include "../PoolDefs.h"
+
+static WorkerPool* currentPool= nullptr;
+static std::atomic<bool> flagSet{ false };
+
+/**
+ * Keeps submitting a copy of itself from the worker thread until the flag is set
+ */
+class SpawnerTask : public Task {
+public:
+    explicit SpawnerTask( Deallocator* d )
+            : Task( d ) {
+        setPriority( Priority::Bulk );
+    }
+
+    void execute( Worker::WorkerInterface& ) override {
+        if( !flagSet ) {
+            currentPool->submitTask( heapAlloc.allocate<SpawnerTask>(), Priority::Bulk );
+        }
+    }
+};
+
+class FlagTask : public Task {
+public:
+    explicit FlagTask( Deallocator* d )
+            : Task( d ) {}
+
+    void execute( Worker::WorkerInterface& ) override {
+        flagSet= true;
+    }
+};
+
+static void testLocalWorkDoesNotStarveInjector() {
+    PoolDefs::T_EventPool pool( 16 );
+    PoolAllocator<PoolDefs::T_EventPool> alloc( pool );
+    EventLoop loop( alloc );
+    WorkerPool workers( loop, 1 );
+    currentPool= &workers;
+
+    // The only worker is kept busy with its own subtasks
+    workers.submitTask( heapAlloc.allocate<SpawnerTask>(), Priority::Bulk );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+
+    workers.submitTask( heapAlloc.allocate<FlagTask>() );
+
+    const auto start= std::chrono::steady_clock::now();
+    while( !flagSet ) {
+        assert( std::chrono::steady_clock::now()- start < std::chrono::seconds( 5 ) );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    workers.stopAndJoin();
+    currentPool= nullptr;
+}
+
+int main() {
+    testLocalWorkDoesNotStarveInjector();
+
+    std::cout << "WorkerPoolTest passed" << std::endl;
+    return 0;
+}